@@ -0,0 +1,227 @@
+/*
+ * File: Adpcm.c
+ *
+ * Description: IMA ADPCM compressed chime decoder.
+ *
+ * Copyright (c) 2018-2019 John Davis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "AudioDxeCfg.h"
+
+//
+// Data layout, as written by Tools/ChimeGen.py --adpcm:
+//
+//   Header: signature, sample rate, channels (UINT16), frames per block
+//   (UINT16), total frames, all little endian.
+//
+//   Blocks: per channel the first sample (INT16) and step index (UINT8,
+//   then a pad byte), followed by 4-bit codes for the remaining frames,
+//   in frame then channel order, low nibble first.
+//
+#define ADPCM_SIGNATURE           SIGNATURE_32 ('A', 'D', 'P', 'M')
+#define ADPCM_HEADER_SIZE         (16)
+#define ADPCM_BLOCK_HEADER_SIZE   (4)
+#define ADPCM_MAX_STEP_INDEX      (88)
+
+STATIC CONST INT8 mAdpcmIndexTable[8] = {
+  -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+STATIC CONST UINT16 mAdpcmStepTable[ADPCM_MAX_STEP_INDEX + 1] = {
+  7,     8,     9,     10,    11,    12,    13,    14,    16,    17,
+  19,    21,    23,    25,    28,    31,    34,    37,    41,    45,
+  50,    55,    60,    66,    73,    80,    88,    97,    107,   118,
+  130,   143,   157,   173,   190,   209,   230,   253,   279,   307,
+  337,   371,   408,   449,   494,   544,   598,   658,   724,   796,
+  876,   963,   1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+  2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,
+  5894,  6484,  7132,  7845,  8630,  9493,  10442, 11487, 12635, 13899,
+  15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+/**
+  Size of a block holding a number of frames.
+**/
+STATIC
+UINTN
+AdpcmBlockSize (
+  IN  ADPCM_SOURCE  *Source,
+  IN  UINTN         Frames
+  )
+{
+  return Source->Source.Channels * ADPCM_BLOCK_HEADER_SIZE + ((Frames - 1) * Source->Source.Channels + 1) / 2;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+AdpcmSourceRead (
+  IN  AUDIO_SOURCE  *This,
+  OUT UINT8         *Buffer,
+  IN  UINTN         Length,
+  OUT UINTN         *ReadLength
+  )
+{
+  ADPCM_SOURCE  *Source;
+  INT16         *Out;
+  UINTN         Frames;
+  UINTN         BlockFrames;
+  INT32         Predictor;
+  INT32         Step;
+  INT32         Diff;
+  UINT8         Code;
+  UINT64        StartTicks;
+  UINTN         i;
+  UINT8         c;
+
+  //
+
+  Source = BASE_CR (This, ADPCM_SOURCE, Source);
+
+  if (Source->Position >= This->TotalSamples) {
+    *ReadLength = 0;
+    return EFI_END_OF_FILE;
+  }
+
+  StartTicks  = GetPerformanceCounter ();
+  Out         = (INT16 *)Buffer;
+  Frames      = MIN (Length / (This->Channels * sizeof (INT16)), This->TotalSamples - Source->Position);
+
+  for (i = 0; i < Frames; i++) {
+    // Blocks start over from a stored sample, so errors never carry over.
+    if (Source->FrameInBlock == 0) {
+      BlockFrames = MIN (Source->BlockFrames, This->TotalSamples - Source->Position);
+      if ((Source->Block + AdpcmBlockSize (Source, BlockFrames)) > Source->DataEnd) {
+        break;
+      }
+
+      for (c = 0; c < This->Channels; c++) {
+        Source->Predictor[c]  = (INT16)ReadUnaligned16 ((CONST UINT16 *)&Source->Block[c * ADPCM_BLOCK_HEADER_SIZE]);
+        Source->StepIndex[c]  = MIN (Source->Block[c * ADPCM_BLOCK_HEADER_SIZE + 2], ADPCM_MAX_STEP_INDEX);
+        *Out++                = (INT16)Source->Predictor[c];
+      }
+
+      Source->Codes   = &Source->Block[This->Channels * ADPCM_BLOCK_HEADER_SIZE];
+      Source->Nibble  = 0;
+    } else {
+      for (c = 0; c < This->Channels; c++) {
+        Code = (Source->Codes[Source->Nibble >> 1] >> ((Source->Nibble & 1) * 4)) & 0x0F;
+        Source->Nibble++;
+
+        Step = mAdpcmStepTable[Source->StepIndex[c]];
+        Diff = Step >> 3;
+        if ((Code & 4) != 0) {
+          Diff += Step;
+        }
+        if ((Code & 2) != 0) {
+          Diff += Step >> 1;
+        }
+        if ((Code & 1) != 0) {
+          Diff += Step >> 2;
+        }
+
+        Predictor = Source->Predictor[c] + (((Code & 8) != 0) ? -Diff : Diff);
+        if (Predictor > MAX_INT16) {
+          Predictor = MAX_INT16;
+        } else if (Predictor < MIN_INT16) {
+          Predictor = MIN_INT16;
+        }
+        Source->Predictor[c] = Predictor;
+
+        Source->StepIndex[c] = (UINT8)MIN (MAX ((INT32)Source->StepIndex[c] + mAdpcmIndexTable[Code & 7], 0), ADPCM_MAX_STEP_INDEX);
+
+        *Out++ = (INT16)Predictor;
+      }
+    }
+
+    Source->Position++;
+    Source->FrameInBlock++;
+    if (Source->FrameInBlock == Source->BlockFrames) {
+      Source->Block        += AdpcmBlockSize (Source, Source->BlockFrames);
+      Source->FrameInBlock  = 0;
+    }
+  }
+
+  Source->DecodeTicks   += GetPerformanceCounter () - StartTicks;
+  Source->DecodedFrames += i;
+
+  *ReadLength = i * This->Channels * sizeof (INT16);
+  if (i == 0) {
+    return EFI_END_OF_FILE;
+  }
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+AdpcmSourceRewind (
+  IN  AUDIO_SOURCE  *This
+  )
+{
+  ADPCM_SOURCE  *Source;
+
+  //
+
+  Source                = BASE_CR (This, ADPCM_SOURCE, Source);
+  Source->Block         = Source->Data + ADPCM_HEADER_SIZE;
+  Source->Position      = 0;
+  Source->FrameInBlock  = 0;
+
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+AdpcmSourceInit (
+  OUT ADPCM_SOURCE  *Source,
+  IN  CONST UINT8   *Data,
+  IN  UINTN         DataLength
+  )
+{
+  UINT16    Channels;
+
+  //
+
+  if ((Data == NULL) || (DataLength < ADPCM_HEADER_SIZE)
+    || (ReadUnaligned32 ((CONST UINT32 *)&Data[0]) != ADPCM_SIGNATURE)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  ZeroMem (Source, sizeof (*Source));
+
+  Channels                    = ReadUnaligned16 ((CONST UINT16 *)&Data[8]);
+  Source->Source.Read         = AdpcmSourceRead;
+  Source->Source.Rewind       = AdpcmSourceRewind;
+  Source->Source.Frequency    = AudioIoFreqFromHz (ReadUnaligned32 ((CONST UINT32 *)&Data[4]));
+  Source->Source.Bits         = EfiAudioIoBits16;
+  Source->Source.Channels     = (UINT8)Channels;
+  Source->Source.TotalSamples = ReadUnaligned32 ((CONST UINT32 *)&Data[12]);
+  Source->Data                = Data;
+  Source->DataEnd             = Data + DataLength;
+  Source->BlockFrames         = ReadUnaligned16 ((CONST UINT16 *)&Data[10]);
+
+  if ((Source->Source.Frequency == 0) || (Channels == 0) || (Channels > ADPCM_MAX_CHANNELS) || (Source->BlockFrames == 0)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  return AdpcmSourceRewind (&Source->Source);
+}
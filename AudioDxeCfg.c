@@ -32,333 +32,214 @@ STATIC CHAR16                           *mDefaultDevices[EfiAudioIoDeviceMaximum
 STATIC CHAR16                           *mLocations[EfiAudioIoLocationMaximum]     = { L"N/A", L"rear", L"front", L"left", L"right", L"top", L"bottom", L"other" };
 STATIC CHAR16                           *mSurfaces[EfiAudioIoSurfaceMaximum]       = { L"external", L"internal", L"other" };
 
+// Chime files looked up next to the application, in order.
+STATIC CHAR16                           *mChimeFileNames[]  = { L"AudioDxeCfgChime.wav", L"AudioDxeCfgChime.mp3", L"AudioDxeCfgChime.adp" };
+
 STATIC UINT8                            mDeviceVolume         = (UINT8)(EFI_AUDIO_IO_PROTOCOL_MAX_VOLUME / 2);
 STATIC AUDIO_DEVICE                     *mDevices             = NULL;
 STATIC AUDIO_DEVICE                     *mCurrentDevice       = NULL;
 STATIC UINTN                            mDevicesCount         = 0;
 
 STATIC UINT8                            *mBuffer              = NULL;
+STATIC BOOLEAN                          mBufferAllocated      = FALSE;
 STATIC UINT32                           mBufferSize           = 0;
 STATIC EFI_AUDIO_IO_PROTOCOL_FREQ       mFrequency            = 0;
 STATIC EFI_AUDIO_IO_PROTOCOL_BITS       mBits                 = 0;
 STATIC UINT8                            mChannels             = 0;
-
+STATIC CONST UINT8                      *mSamplerData         = NULL;
+STATIC UINTN                            mSamplerDataLength    = 0;
+STATIC BOOLEAN                          mSamplerDataAllocated = FALSE;
+STATIC FILE_SOURCE                      mFileSource;
+STATIC MP3_STREAM                       mMp3Stream;
+STATIC ADPCM_SOURCE                     mAdpcmSource;
+STATIC MEMORY_SOURCE                    mMemorySource;
+STATIC AUDIO_SOURCE                     *mSource              = NULL;
+
+// Sampler converted for the last output format used.
+STATIC UINT8                            *mConvertedBuffer     = NULL;
+STATIC EFI_AUDIO_IO_PROTOCOL_FREQ       mConvertedFreq        = 0;
+STATIC EFI_AUDIO_IO_PROTOCOL_BITS       mConvertedBits        = 0;
+STATIC UINT8                            mConvertedChannels    = 0;
+STATIC MEMORY_SOURCE                    mConvertedSource;
+STATIC RESAMPLE_SOURCE                  mResampleSource;
+STATIC CONVERT_SOURCE                   mConvertSource;
+
+// Software volume, with the sampler scaled for the last volume used.
+STATIC BOOLEAN                          mSoftwareVolume       = FALSE;
+STATIC UINT8                            *mScaledBuffer        = NULL;
+STATIC CONST UINT8                      *mScaledData          = NULL;
+STATIC UINT8                            mScaledVolume         = 0;
+STATIC MEMORY_SOURCE                    mScaledSource;
+STATIC GAIN_SOURCE                      mGainSource;
+
+// Sample widths, narrowest first.
+STATIC CONST EFI_AUDIO_IO_PROTOCOL_BITS mBitsOrder[] = {
+  EfiAudioIoBits8, EfiAudioIoBits16, EfiAudioIoBits20, EfiAudioIoBits24, EfiAudioIoBits32
+};
+
+STATIC AUDIO_TIMINGS                    mTimings;
+
+// Results of the last sweep, per output.
+STATIC SWEEP_RESULT                     *mSweepResults        = NULL;
+STATIC UINTN                            mSweepResultCount     = 0;
+
+// Keys read ahead of their consumer, e.g. pasted over a serial console.
+STATIC CHAR16                           mKeyQueue[KEY_QUEUE_SIZE];
+STATIC UINTN                            mKeyQueueHead         = 0;
+STATIC UINTN                            mKeyQueueCount        = 0;
+
+// Esc is never queued, it stops playback instead.
+STATIC BOOLEAN                          mCancelPending        = FALSE;
+
+/**
+  Move pending keystrokes into the key queue, without blocking.
+  Keys beyond the queue size are left with the console, except Esc
+  presses, which are recorded as a playback cancel request.
+**/
 STATIC
 VOID
-FlushKeystrokes (
+PollKeystrokes (
   VOID
   )
 {
-  EFI_STATUS      Status;
   EFI_INPUT_KEY   InputKey;
 
   //
 
-  // Check if parameters are valid.
-  if (mSimpleTextIn == NULL) {
-    return;
-  }
+  while (mKeyQueueCount < KEY_QUEUE_SIZE) {
+    if (EFI_ERROR (mSimpleTextIn->ReadKeyStroke (mSimpleTextIn, &InputKey))) {
+      break;
+    }
 
-  // Flush any keystrokes.
-  do {
-    gBS->Stall (100);
-    Status = mSimpleTextIn->ReadKeyStroke (mSimpleTextIn, &InputKey);
-  } while (!EFI_ERROR (Status));
+    // Serial consoles send \r\n for enter, only \r is used.
+    if (InputKey.UnicodeChar == L'\n') {
+      continue;
+    }
+
+    if (InputKey.ScanCode == SCAN_ESC) {
+      mCancelPending = TRUE;
+      continue;
+    }
+
+    mKeyQueue[(mKeyQueueHead + mKeyQueueCount) % KEY_QUEUE_SIZE] = InputKey.UnicodeChar;
+    mKeyQueueCount++;
+  }
 }
 
 STATIC
-EFI_STATUS
-WaitForKey (
-  OUT CHAR16    *KeyValue
+VOID
+FlushKeystrokes (
+  VOID
   )
 {
-  EFI_STATUS      Status;
-  UINTN           EventIndex;
   EFI_INPUT_KEY   InputKey;
+  UINT64          StartTicks;
 
   //
 
   // Check if parameters are valid.
-  if ((mSimpleTextIn == NULL) || (KeyValue == NULL)) {
-    return EFI_INVALID_PARAMETER;
+  if (mSimpleTextIn == NULL) {
+    return;
   }
 
-  while (TRUE) {
-    // Wait for key.
-    gBS->WaitForEvent (1, &(mSimpleTextIn->WaitForKey), &EventIndex);
-
-    // Get key value.
-    Status = mSimpleTextIn->ReadKeyStroke (mSimpleTextIn, &InputKey);
-
-    if (!EFI_ERROR (Status)) {
-      // If \n, wait again.
-      if (InputKey.UnicodeChar == L'\n') {
-        return WaitForKey (KeyValue);
-      }
+  StartTicks = GetPerformanceCounter ();
 
-      // Success.
-      *KeyValue = InputKey.UnicodeChar;
+  // Drop queued keys.
+  mKeyQueueHead   = 0;
+  mKeyQueueCount  = 0;
+  mCancelPending  = FALSE;
 
-      return EFI_SUCCESS;
+  // Flush any keystrokes, as long as the key event reports pending ones.
+  while (!EFI_ERROR (gBS->CheckEvent (mSimpleTextIn->WaitForKey))) {
+    if (EFI_ERROR (mSimpleTextIn->ReadKeyStroke (mSimpleTextIn, &InputKey))) {
+      break;
     }
   }
 
-  return EFI_DEVICE_ERROR;
+  mTimings.FlushTicks += GetPerformanceCounter () - StartTicks;
+  mTimings.FlushCount++;
 }
 
+/**
+  Queue keys pressed during playback as type-ahead, and report whether Esc
+  was pressed since playback started.
+**/
 STATIC
-EFI_STATUS
-GetAudioDecoder (
+BOOLEAN
+PollCancelKey (
   VOID
   )
 {
-  EFI_STATUS                  Status;
-  EFI_AUDIO_DECODE_PROTOCOL   *AudioDecodeProtocol;
+  BOOLEAN   Cancel;
 
   //
 
-  Status = gBS->LocateProtocol (
-    &gEfiAudioDecodeProtocolGuid,
-    NULL,
-    (VOID **)&AudioDecodeProtocol
-    );
-  if (!EFI_ERROR (Status)) {
-    Status = AudioDecodeProtocol->DecodeAny (
-      AudioDecodeProtocol,
-      &mChimeData[0],
-      (UINT32)mChimeDataLength,
-      (VOID **)&mBuffer,
-      &mBufferSize,
-      &mFrequency,
-      &mBits,
-      &mChannels
-      );
-    if (EFI_ERROR (Status)) {
-      Print (L"Decoding audio buffer fail - %r\n", Status);
-    }
-  } else {
-    Print (L"Cannot locate audio decoder protocol - %r\n", Status);
-  }
+  PollKeystrokes ();
 
-  return Status;
-}
+  Cancel          = mCancelPending;
+  mCancelPending  = FALSE;
 
+  return Cancel;
+}
 
 STATIC
 EFI_STATUS
-GetOutputDevices (
-  VOID
+WaitForKey (
+  OUT CHAR16    *KeyValue
   )
 {
-  EFI_STATUS                    Status;
-  EFI_HANDLE                    *AudioIoHandles;
-  UINTN                         AudioIoHandleCount;
-  EFI_AUDIO_IO_PROTOCOL         *AudioIo;
-  EFI_DEVICE_PATH_PROTOCOL      *DevicePath;
-  EFI_AUDIO_IO_PROTOCOL_PORT    *OutputPorts;
-  UINTN                         OutputPortsCount;
-  UINTN                         h;
-
-  // Devices.
-  AUDIO_DEVICE    *OutputDevices;
-  AUDIO_DEVICE    *OutputDevicesNew;
-  UINTN           OutputDevicesCount;
-  UINTN           OutputDeviceIndex;
-  UINTN           o;
+  UINTN   EventIndex;
 
   //
 
-  // Get Audio I/O protocols in system.
-  AudioIoHandles      = NULL;
-  AudioIoHandleCount  = 0;
-  Status              = gBS->LocateHandleBuffer (ByProtocol, &gEfiAudioIoProtocolGuid, NULL, &AudioIoHandleCount, &AudioIoHandles);
-  if (EFI_ERROR (Status)) {
-    return Status;
+  // Check if parameters are valid.
+  if ((mSimpleTextIn == NULL) || (KeyValue == NULL)) {
+    return EFI_INVALID_PARAMETER;
   }
 
-  OutputDevices       = NULL;
-  OutputDevicesCount  = 0;
-  OutputDeviceIndex   = 0;
-
-  // Discover audio outputs in system.
-  for (h = 0; h < AudioIoHandleCount; h++) {
-    // Open Audio I/O protocol.
-    Status = gBS->HandleProtocol (AudioIoHandles[h], &gEfiAudioIoProtocolGuid, (VOID**)&AudioIo);
-    if (EFI_ERROR (Status)) {
-      continue;
-    }
-
-    // Get device path.
-    Status = gBS->HandleProtocol (AudioIoHandles[h], &gEfiDevicePathProtocolGuid, (VOID**)&DevicePath);
-    if (EFI_ERROR (Status)) {
-      continue;
-    }
-
-    // Get output devices.
-    Status = AudioIo->GetOutputs (AudioIo, &OutputPorts, &OutputPortsCount);
-    if (EFI_ERROR (Status)) {
-      continue;
-    }
-
-    // Increase total output devices.
-    OutputDevicesNew = ReallocatePool (OutputDevicesCount * sizeof (AUDIO_DEVICE),
-                          (OutputDevicesCount + OutputPortsCount) * sizeof (AUDIO_DEVICE),
-                          OutputDevices);
-    if (OutputDevicesNew == NULL) {
-      FreePool (OutputPorts);
-      Status = EFI_OUT_OF_RESOURCES;
-      goto DONE_ERROR;
-    }
-    OutputDevices       = OutputDevicesNew;
-    OutputDevicesCount += OutputPortsCount;
-
-    // Get devices on this protocol.
-    for (o = 0; o < OutputPortsCount; o++) {
-      OutputDevices[OutputDeviceIndex].AudioIo          = AudioIo;
-      OutputDevices[OutputDeviceIndex].DevicePath       = DevicePath;
-      OutputDevices[OutputDeviceIndex].OutputPort       = OutputPorts[o];
-      OutputDevices[OutputDeviceIndex].OutputPortIndex  = o;
-      OutputDeviceIndex++;
-    }
-
-    // Free output ports.
-    FreePool (OutputPorts);
+  // Type-ahead keys are used first.
+  PollKeystrokes ();
+  while (mKeyQueueCount == 0) {
+    // Wait for key.
+    gBS->WaitForEvent (1, &(mSimpleTextIn->WaitForKey), &EventIndex);
+    PollKeystrokes ();
   }
 
   // Success.
-  mDevices        = OutputDevices;
-  mDevicesCount   = OutputDevicesCount;
-  mCurrentDevice  = &mDevices[0];
-
-  Status = EFI_SUCCESS;
-
-  goto DONE;
-
-  DONE_ERROR:
-
-  // Free devices.
-  if (OutputDevices != NULL) {
-    FreePool (OutputDevices);
-  }
-
-  DONE:
-
-  // Free stuff.
-  if (AudioIoHandles != NULL) {
-    FreePool (AudioIoHandles);
-  }
-
-  return Status;
-}
-
-STATIC
-EFI_DEVICE_PATH_PROTOCOL *
-GetRootDevicePath (
-  IN  EFI_DEVICE_PATH_PROTOCOL    *DevicePath
-  )
-{
-  EFI_DEVICE_PATH_PROTOCOL    *TmpDevicePath;
-  VENDOR_DEVICE_PATH          *VendorDevicePath;
-
-  //
-
-  if (DevicePath != NULL) {
-    TmpDevicePath = DuplicateDevicePath (DevicePath);
-    if (TmpDevicePath != NULL) {
-      VendorDevicePath  = (VENDOR_DEVICE_PATH *)FindDevicePathNodeWithType (
-                                                  TmpDevicePath,
-                                                  MESSAGING_DEVICE_PATH,
-                                                  MSG_VENDOR_DP);
-      if (VendorDevicePath != NULL) {
-        SetDevicePathEndNode (VendorDevicePath);
-        return TmpDevicePath;
-      }
-
-      FreePool (TmpDevicePath);
-    }
-  }
+  *KeyValue       = mKeyQueue[mKeyQueueHead];
+  mKeyQueueHead   = (mKeyQueueHead + 1) % KEY_QUEUE_SIZE;
+  mKeyQueueCount--;
 
-  return NULL;
+  return EFI_SUCCESS;
 }
 
 STATIC
-EFI_STATUS
-PrintDevices (
-  VOID
+BOOLEAN
+IsFormatSupported (
+  IN  EFI_AUDIO_IO_PROTOCOL_PORT  *OutputPort,
+  IN  EFI_AUDIO_IO_PROTOCOL_FREQ  Frequency,
+  IN  EFI_AUDIO_IO_PROTOCOL_BITS  Bits
   )
 {
-  EFI_STATUS                Status;
-  CHAR16                    KeyValue;
-  UINTN                     i;
-  UINTN                     s;
-  UINTN                     Len;
-  CHAR16                    *TextDevicePath;
-  EFI_DEVICE_PATH_PROTOCOL  *TmpDevicePath;
-
-  //
-
-  // Check that parameters are valid.
-  if ((mSimpleTextIn == NULL) || (mDevices == NULL)) {
-    return EFI_INVALID_PARAMETER;
-  }
-
-  // Print each device.
-  Print (L"Output devices:\n");
-
-  Len = StrLen (PROMPT_ANY_KEY);
-
-  for (i = 0; i < mDevicesCount; i++) {
-    // Every 10 devices, wait for keystroke.
-    if ((i > 0) && ((i % 10) == 0)) {
-      Print (PROMPT_ANY_KEY);
-
-      Status = WaitForKey (&KeyValue);
-      if (EFI_ERROR (Status)) {
-        return Status;
-      }
-
-      FlushKeystrokes ();
-
-      // Clear prompt line.
-      for (s = 0; s < Len; s++) {
-        Print (L"\b");
-      }
-    }
-
-    TmpDevicePath   = GetRootDevicePath (mDevices[i].DevicePath);
-    TextDevicePath  = ConvertDevicePathToText ((TmpDevicePath != NULL) ? TmpDevicePath : mDevices[i].DevicePath, FALSE, FALSE);
-
-    // Print device.
-    Print (L"%lu. %s - %s %s (Port: %lu) - %s\n",
-      i + 1,
-      mDefaultDevices[mDevices[i].OutputPort.Device],
-      mLocations[mDevices[i].OutputPort.Location],
-      mSurfaces[mDevices[i].OutputPort.Surface],
-      mDevices[i].OutputPortIndex,
-      TextDevicePath);
-
-    if (TextDevicePath != NULL) {
-      FreePool (TextDevicePath);
-    }
-
-    if (TmpDevicePath != NULL) {
-      FreePool (TmpDevicePath);
-    }
-  }
-
-  return EFI_SUCCESS;
+  return ((OutputPort->SupportedFreqs & Frequency) != 0) && ((OutputPort->SupportedBits & Bits) != 0);
 }
 
+/**
+  Open the directory the application was loaded from in OpenMode. With
+  Fallback, the root of the first writable filesystem is opened when that is
+  not available, otherwise EFI_NOT_FOUND is returned quietly.
+**/
 STATIC
 EFI_STATUS
-DumpDevices (
-  VOID
+OpenSelfDirectory (
+  OUT EFI_FILE_PROTOCOL   **Dir,
+  IN  UINT64              OpenMode,
+  IN  BOOLEAN             Fallback
   )
 {
   EFI_STATUS                  Status;
   EFI_LOADED_IMAGE_PROTOCOL   *LoadedImage;
   EFI_FILE_PROTOCOL           *RootDir;
-  EFI_FILE_PROTOCOL           *Dir;
   CHAR16                      *DirectoryName;
   UINTN                       i;
   UINTN                       Len;
@@ -393,25 +274,31 @@ DumpDevices (
     DirectoryName = NULL;
   }
 
+  if ((RootDir == NULL) && !Fallback) {
+    if (DirectoryName != NULL) {
+      FreePool (DirectoryName);
+    }
+    return EFI_NOT_FOUND;
+  }
+
   if (RootDir == NULL) {
     Status = FindWritableFileSystem (&RootDir);
     if (EFI_ERROR (Status)) {
-      Print (L"No usable filesystem for report - %r\n", Status);
+      Print (L"No usable filesystem - %r\n", Status);
+      if (DirectoryName != NULL) {
+        FreePool (DirectoryName);
+      }
       return EFI_NOT_FOUND;
     }
   }
 
   Status = SafeFileOpen (
     RootDir,
-    &Dir,
+    Dir,
     (DirectoryName != NULL) ? DirectoryName : L"\\",
-    EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE,
+    OpenMode,
     EFI_FILE_DIRECTORY
     );
-  if (!EFI_ERROR (Status)) {
-    Status = OcAudioDump (Dir);
-    Dir->Close (Dir);
-  }
 
   RootDir->Close (RootDir);
 
@@ -419,68 +306,2242 @@ DumpDevices (
     FreePool (DirectoryName);
   }
 
-  return EFI_SUCCESS;
+  return Status;
 }
 
+/**
+  Look for a chime file next to the application. PCM WAV files are streamed
+  from the file as they are played, other files are loaded whole for the
+  decoders below.
+**/
 STATIC
 EFI_STATUS
-PrintCurrentDevice (
+LoadChimeFile (
   VOID
   )
 {
-  EFI_DEVICE_PATH_PROTOCOL  *TmpDevicePath;
-  CHAR16                    *TextDevicePath;
+  EFI_STATUS          Status;
+  EFI_FILE_PROTOCOL   *Dir;
+  EFI_FILE_PROTOCOL   *File;
+  UINT32              FileSize;
+  UINT8               *Data;
+  UINTN               i;
 
   //
 
-  if (mCurrentDevice == NULL) {
-    return EFI_INVALID_PARAMETER;
+  Status = OpenSelfDirectory (&Dir, EFI_FILE_MODE_READ, FALSE);
+  if (EFI_ERROR (Status)) {
+    return Status;
   }
 
-  TmpDevicePath   = GetRootDevicePath (mCurrentDevice->DevicePath);
-  TextDevicePath  = ConvertDevicePathToText ((TmpDevicePath != NULL) ? TmpDevicePath : mCurrentDevice->DevicePath, FALSE, FALSE);
+  for (i = 0; i < ARRAY_SIZE (mChimeFileNames); i++) {
+    Status = SafeFileOpen (Dir, &File, mChimeFileNames[i], EFI_FILE_MODE_READ, 0);
+    if (!EFI_ERROR (Status)) {
+      break;
+    }
+  }
 
-  // Success.
-  Print (L"Output: %s - %s %s (Port: %lu) - %s\n",
-    mDefaultDevices[mCurrentDevice->OutputPort.Device],
-    mLocations[mCurrentDevice->OutputPort.Location],
-    mSurfaces[mCurrentDevice->OutputPort.Surface],
-    mCurrentDevice->OutputPortIndex,
-    TextDevicePath);
+  Dir->Close (Dir);
+
+  if (EFI_ERROR (Status)) {
+    return EFI_NOT_FOUND;
+  }
+
+  // The file stays open for playback.
+  Status = FileSourceOpen (&mFileSource, File);
+  if (!EFI_ERROR (Status)) {
+    mFrequency  = mFileSource.Source.Frequency;
+    mBits       = mFileSource.Source.Bits;
+    mChannels   = mFileSource.Source.Channels;
+    mBufferSize = (UINT32)mFileSource.DataLength;
+    mSource     = &mFileSource.Source;
+
+    Print (L"Sampler: %s, streamed\n", mChimeFileNames[i]);
+    return EFI_SUCCESS;
+  }
 
-  if (TextDevicePath != NULL) {
-    FreePool (TextDevicePath);
+  Data    = NULL;
+  Status  = GetFileSize (File, &FileSize);
+  if (!EFI_ERROR (Status)) {
+    if ((FileSize == 0) || (FileSize > CHIME_FILE_MAX_SIZE)) {
+      Status = EFI_UNSUPPORTED;
+    } else {
+      Data = AllocatePool (FileSize);
+      if (Data == NULL) {
+        Status = EFI_OUT_OF_RESOURCES;
+      } else {
+        Status = GetFileData (File, 0, FileSize, Data);
+      }
+    }
   }
 
-  if (TmpDevicePath != NULL) {
-    FreePool (TmpDevicePath);
+  File->Close (File);
+
+  if (EFI_ERROR (Status)) {
+    Print (L"Sampler: %s cannot be loaded - %r\n", mChimeFileNames[i], Status);
+    if (Data != NULL) {
+      FreePool (Data);
+    }
+    return Status;
   }
 
+  mSamplerData          = Data;
+  mSamplerDataLength    = FileSize;
+  mSamplerDataAllocated = TRUE;
+
+  Print (L"Sampler: %s, %u bytes loaded\n", mChimeFileNames[i], FileSize);
   return EFI_SUCCESS;
 }
 
 STATIC
 EFI_STATUS
-PrintCurrentSetting (
+DecodeSampler (
   VOID
   )
 {
-  EFI_STATUS    Status;
+  EFI_STATUS                  Status;
+  EFI_AUDIO_DECODE_PROTOCOL   *AudioDecodeProtocol;
+  WAVE_INFO                   WaveInfo;
+
+  //
+
+  mSamplerData        = &mChimeData[0];
+  mSamplerDataLength  = mChimeDataLength;
+
+  Status = LoadChimeFile ();
+  if (!EFI_ERROR (Status) && (mSource != NULL)) {
+    return EFI_SUCCESS;
+  }
+
+  // Pre-decoded samplers are played straight from the embedded data.
+  if (!mSamplerDataAllocated && (mChimeDataFreq != 0)) {
+    mBuffer     = &mChimeData[0];
+    mBufferSize = (UINT32)mChimeDataLength;
+    mFrequency  = mChimeDataFreq;
+    mBits       = mChimeDataBits;
+    mChannels   = mChimeDataChannels;
+
+    goto DONE_BUFFER;
+  }
+
+  // Plain PCM WAV samplers are played in place, without a decoded copy.
+  Status = WaveParse (mSamplerData, mSamplerDataLength, &WaveInfo);
+  if (!EFI_ERROR (Status)) {
+    Status = WaveGetAudioIoFormat (&WaveInfo, &mFrequency, &mBits);
+    if (!EFI_ERROR (Status)) {
+      mBuffer     = (UINT8 *)&mSamplerData[WaveInfo.DataOffset];
+      mBufferSize = WaveInfo.DataLength;
+      mChannels   = (UINT8)WaveInfo.Channels;
+
+      goto DONE_BUFFER;
+    }
+  }
+
+  // ADPCM samplers are decoded as they are played, straight into the stream buffers.
+  Status = AdpcmSourceInit (&mAdpcmSource, mSamplerData, mSamplerDataLength);
+  if (!EFI_ERROR (Status)) {
+    mFrequency  = mAdpcmSource.Source.Frequency;
+    mBits       = mAdpcmSource.Source.Bits;
+    mChannels   = mAdpcmSource.Source.Channels;
+    mBufferSize = (UINT32)(mAdpcmSource.Source.TotalSamples * mChannels * AudioIoBytesPerSample (mBits));
+    mSource     = &mAdpcmSource.Source;
+
+    return EFI_SUCCESS;
+  }
+
+  Status = gBS->LocateProtocol (
+    &gEfiAudioDecodeProtocolGuid,
+    NULL,
+    (VOID **)&AudioDecodeProtocol
+    );
+  if (EFI_ERROR (Status)) {
+    Print (L"Cannot locate audio decoder protocol - %r\n", Status);
+    return Status;
+  }
+
+  // Stream MP3 samplers chunk by chunk, the format is probed from the first chunk.
+  Status = Mp3StreamOpen (&mMp3Stream, AudioDecodeProtocol, mSamplerData, mSamplerDataLength);
+  if (!EFI_ERROR (Status)) {
+    mFrequency  = mMp3Stream.Source.Frequency;
+    mBits       = mMp3Stream.Source.Bits;
+    mChannels   = mMp3Stream.Source.Channels;
+    mBufferSize = (UINT32)(mMp3Stream.Source.TotalSamples * mChannels * AudioIoBytesPerSample (mBits));
+    mSource     = &mMp3Stream.Source;
+
+    return EFI_SUCCESS;
+  }
+
+  // Decode whole sampler otherwise.
+  Status = AudioDecodeProtocol->DecodeAny (
+    AudioDecodeProtocol,
+    mSamplerData,
+    (UINT32)mSamplerDataLength,
+    (VOID **)&mBuffer,
+    &mBufferSize,
+    &mFrequency,
+    &mBits,
+    &mChannels
+    );
+  if (EFI_ERROR (Status)) {
+    Print (L"Decoding audio buffer fail - %r\n", Status);
+    return Status;
+  }
+  mBufferAllocated = TRUE;
+
+  DONE_BUFFER:
+
+  MemorySourceInit (&mMemorySource, mBuffer, mBufferSize, mFrequency, mBits, mChannels);
+  mSource = &mMemorySource.Source;
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+GetAudioDecoder (
+  VOID
+  )
+{
+  EFI_STATUS    Status;
+  UINT64        StartTicks;
+
+  //
+
+  // Sampler is decoded on first use only, and kept for later tests.
+  if (mSource != NULL) {
+    return EFI_SUCCESS;
+  }
+
+  StartTicks            = GetPerformanceCounter ();
+  Status                = DecodeSampler ();
+  mTimings.DecodeTicks  = GetPerformanceCounter () - StartTicks;
+
+  return Status;
+}
+
+STATIC
+EFI_DEVICE_PATH_PROTOCOL *
+GetRootDevicePath (
+  IN  EFI_DEVICE_PATH_PROTOCOL    *DevicePath
+  )
+{
+  EFI_DEVICE_PATH_PROTOCOL    *TmpDevicePath;
+  VENDOR_DEVICE_PATH          *VendorDevicePath;
+
+  //
+
+  if (DevicePath != NULL) {
+    TmpDevicePath = DuplicateDevicePath (DevicePath);
+    if (TmpDevicePath != NULL) {
+      VendorDevicePath  = (VENDOR_DEVICE_PATH *)FindDevicePathNodeWithType (
+                                                  TmpDevicePath,
+                                                  MESSAGING_DEVICE_PATH,
+                                                  MSG_VENDOR_DP);
+      if (VendorDevicePath != NULL) {
+        SetDevicePathEndNode (VendorDevicePath);
+        return TmpDevicePath;
+      }
+
+      FreePool (TmpDevicePath);
+    }
+  }
+
+  return NULL;
+}
+
+STATIC
+EFI_STATUS
+GetOutputDevices (
+  VOID
+  )
+{
+  EFI_STATUS                    Status;
+  EFI_HANDLE                    *AudioIoHandles;
+  UINTN                         AudioIoHandleCount;
+  AUDIO_IO_OUTPUTS              *AudioIoOutputs;
+  AUDIO_IO_OUTPUTS              *Outputs;
+  UINTN                         h;
+  UINT64                        StartTicks;
+  UINT64                        HandleStartTicks;
+  EFI_FILE_PROTOCOL             *CacheDir;
+  BOOLEAN                       CacheComplete;
+
+  // Devices.
+  AUDIO_DEVICE    *OutputDevices;
+  UINTN           OutputDevicesCount;
+  UINTN           OutputDeviceIndex;
+  UINTN           o;
+
+  //
+
+  StartTicks = GetPerformanceCounter ();
+
+  // Get Audio I/O protocols in system.
+  AudioIoHandles      = NULL;
+  AudioIoHandleCount  = 0;
+  Status              = gBS->LocateHandleBuffer (ByProtocol, &gEfiAudioIoProtocolGuid, NULL, &AudioIoHandleCount, &AudioIoHandles);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  OutputDevices       = NULL;
+  OutputDevicesCount  = 0;
+  OutputDeviceIndex   = 0;
+  CacheComplete       = TRUE;
+
+  AudioIoOutputs          = AllocateZeroPool (AudioIoHandleCount * sizeof (AUDIO_IO_OUTPUTS));
+  mTimings.HandleTicks    = AllocateZeroPool (AudioIoHandleCount * sizeof (UINT64));
+  mTimings.HandleOutputs  = AllocateZeroPool (AudioIoHandleCount * sizeof (UINTN));
+  if ((AudioIoOutputs == NULL) || (mTimings.HandleTicks == NULL) || (mTimings.HandleOutputs == NULL)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto DONE;
+  }
+  mTimings.HandleCount    = AudioIoHandleCount;
+
+  //
+  // First pass, open protocols of each handle.
+  //
+  for (h = 0; h < AudioIoHandleCount; h++) {
+    Outputs = &AudioIoOutputs[h];
+
+    // Open Audio I/O protocol.
+    Status = gBS->HandleProtocol (AudioIoHandles[h], &gEfiAudioIoProtocolGuid, (VOID**)&Outputs->AudioIo);
+    if (EFI_ERROR (Status)) {
+      Outputs->AudioIo = NULL;
+      continue;
+    }
+
+    // Get device path.
+    Status = gBS->HandleProtocol (AudioIoHandles[h], &gEfiDevicePathProtocolGuid, (VOID**)&Outputs->DevicePath);
+    if (EFI_ERROR (Status)) {
+      Outputs->AudioIo    = NULL;
+      Outputs->DevicePath = NULL;
+    }
+  }
+
+  //
+  // Outputs are taken from the cache when all handles have the same device
+  // paths. The cache only ever lives next to the application, and is opened
+  // for writing only when it needs to be replaced.
+  //
+  if (!EFI_ERROR (OpenSelfDirectory (&CacheDir, EFI_FILE_MODE_READ, FALSE))) {
+    mTimings.EnumerationCached = !EFI_ERROR (DeviceCacheLoad (CacheDir, AudioIoOutputs, AudioIoHandleCount));
+    CacheDir->Close (CacheDir);
+  }
+
+  //
+  // Second pass, query outputs of each handle to size the device list.
+  //
+  for (h = 0; h < AudioIoHandleCount; h++) {
+    HandleStartTicks  = GetPerformanceCounter ();
+    Outputs           = &AudioIoOutputs[h];
+
+    if (Outputs->AudioIo == NULL) {
+      continue;
+    }
+
+    if (!mTimings.EnumerationCached) {
+      // Get output devices.
+      Status = Outputs->AudioIo->GetOutputs (Outputs->AudioIo, &Outputs->OutputPorts, &Outputs->OutputPortsCount);
+      if (EFI_ERROR (Status)) {
+        Outputs->OutputPorts      = NULL;
+        Outputs->OutputPortsCount = 0;
+        CacheComplete             = FALSE;
+        continue;
+      }
+    }
+
+    // Resolve device path text once, shared by all outputs of this handle.
+    if (Outputs->OutputPortsCount > 0) {
+      Outputs->RootDevicePath = GetRootDevicePath (Outputs->DevicePath);
+      if (Outputs->DevicePathText == NULL) {
+        Outputs->DevicePathText = ConvertDevicePathToText (
+          (Outputs->RootDevicePath != NULL) ? Outputs->RootDevicePath : Outputs->DevicePath,
+          FALSE,
+          FALSE
+          );
+      }
+    }
+
+    OutputDevicesCount       += Outputs->OutputPortsCount;
+    mTimings.HandleTicks[h]   = GetPerformanceCounter () - HandleStartTicks;
+    mTimings.HandleOutputs[h] = Outputs->OutputPortsCount;
+  }
+
+  // Failing to write the cache only costs the next start a full enumeration.
+  if (!mTimings.EnumerationCached && CacheComplete
+    && !EFI_ERROR (OpenSelfDirectory (&CacheDir, EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE, FALSE))) {
+    DeviceCacheSave (CacheDir, AudioIoOutputs, AudioIoHandleCount);
+    CacheDir->Close (CacheDir);
+  }
+
+  // Single allocation for all outputs.
+  if (OutputDevicesCount > 0) {
+    OutputDevices = AllocatePool (OutputDevicesCount * sizeof (AUDIO_DEVICE));
+    if (OutputDevices == NULL) {
+      Status = EFI_OUT_OF_RESOURCES;
+      goto DONE;
+    }
+  }
+
+  //
+  // Third pass, fill in devices.
+  //
+  for (h = 0; h < AudioIoHandleCount; h++) {
+    Outputs = &AudioIoOutputs[h];
+
+    for (o = 0; o < Outputs->OutputPortsCount; o++) {
+      OutputDevices[OutputDeviceIndex].AudioIo          = Outputs->AudioIo;
+      OutputDevices[OutputDeviceIndex].DevicePath       = Outputs->DevicePath;
+      OutputDevices[OutputDeviceIndex].RootDevicePath   = Outputs->RootDevicePath;
+      OutputDevices[OutputDeviceIndex].DevicePathText   = Outputs->DevicePathText;
+      OutputDevices[OutputDeviceIndex].OutputPort       = Outputs->OutputPorts[o];
+      OutputDevices[OutputDeviceIndex].OutputPortIndex  = o;
+      OutputDeviceIndex++;
+    }
+  }
+
+  // Success.
+  mDevices        = OutputDevices;
+  mDevicesCount   = OutputDevicesCount;
+  mCurrentDevice  = &mDevices[0];
+
+  Status = EFI_SUCCESS;
+
+  DONE:
+
+  // Free stuff. Device path text is owned by the device list on success.
+  if (AudioIoOutputs != NULL) {
+    for (h = 0; h < AudioIoHandleCount; h++) {
+      if (AudioIoOutputs[h].OutputPorts != NULL) {
+        FreePool (AudioIoOutputs[h].OutputPorts);
+      }
+
+      if (EFI_ERROR (Status)) {
+        if (AudioIoOutputs[h].DevicePathText != NULL) {
+          FreePool (AudioIoOutputs[h].DevicePathText);
+        }
+
+        if (AudioIoOutputs[h].RootDevicePath != NULL) {
+          FreePool (AudioIoOutputs[h].RootDevicePath);
+        }
+      }
+    }
+    FreePool (AudioIoOutputs);
+  }
+
+  if (AudioIoHandles != NULL) {
+    FreePool (AudioIoHandles);
+  }
+
+  mTimings.EnumerationTicks = GetPerformanceCounter () - StartTicks;
+
+  return Status;
+}
+
+STATIC
+VOID
+FreeOutputDevices (
+  VOID
+  )
+{
+  UINTN   i;
+
+  //
+
+  if (mDevices == NULL) {
+    return;
+  }
+
+  // Shared strings are freed through the first output of each handle.
+  for (i = 0; i < mDevicesCount; i++) {
+    if (mDevices[i].OutputPortIndex == 0) {
+      if (mDevices[i].DevicePathText != NULL) {
+        FreePool (mDevices[i].DevicePathText);
+      }
+
+      if (mDevices[i].RootDevicePath != NULL) {
+        FreePool (mDevices[i].RootDevicePath);
+      }
+    }
+  }
+
+  FreePool (mDevices);
+  mDevices        = NULL;
+  mDevicesCount   = 0;
+  mCurrentDevice  = NULL;
+}
+
+STATIC
+EFI_STATUS
+PrintDevices (
+  VOID
+  )
+{
+  EFI_STATUS                Status;
+  CHAR16                    KeyValue;
+  UINTN                     i;
+  UINTN                     s;
+  UINTN                     Len;
+
+  //
+
+  // Check that parameters are valid.
+  if (mDevices == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  // Print each device.
+  Print (L"Output devices:\n");
+
+  Len = StrLen (PROMPT_ANY_KEY);
+
+  for (i = 0; i < mDevicesCount; i++) {
+    // Every 10 devices, wait for keystroke, unless running a script.
+    if ((mSimpleTextIn != NULL) && (i > 0) && ((i % 10) == 0)) {
+      Print (PROMPT_ANY_KEY);
+
+      Status = WaitForKey (&KeyValue);
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+
+      // Clear prompt line.
+      for (s = 0; s < Len; s++) {
+        Print (L"\b");
+      }
+    }
+
+    // Print device.
+    Print (L"%lu. %s - %s %s (Port: %lu) - %s\n",
+      i + 1,
+      mDefaultDevices[mDevices[i].OutputPort.Device],
+      mLocations[mDevices[i].OutputPort.Location],
+      mSurfaces[mDevices[i].OutputPort.Surface],
+      mDevices[i].OutputPortIndex,
+      mDevices[i].DevicePathText);
+  }
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+CHAR8 *
+FormatTimings (
+  OUT UINTN   *Length
+  )
+{
+  EFI_STATUS                  Status;
+  EFI_LOADED_IMAGE_PROTOCOL   *LoadedImage;
+  CHAR8                       *Report;
+  UINTN                       Size;
+  UINTN                       Offset;
+  UINTN                       h;
+
+  //
+
+  Size    = TIMINGS_REPORT_SIZE + mTimings.HandleCount * TIMINGS_REPORT_LINE_SIZE;
+  Report  = AllocatePool (Size);
+  if (Report == NULL) {
+    return NULL;
+  }
+
+  Offset  = AsciiSPrint (Report, Size, "ConIn check: %Lu us\n", DivU64x32 (GetTimeInNanoSecond (mTimings.ConInTicks), 1000));
+  Offset += AsciiSPrint (Report + Offset, Size - Offset, "Enumeration: %Lu us (%lu handles, %lu outputs%a)\n",
+              DivU64x32 (GetTimeInNanoSecond (mTimings.EnumerationTicks), 1000),
+              mTimings.HandleCount,
+              mDevicesCount,
+              mTimings.EnumerationCached ? ", cached" : "");
+  if (mDevicesCount > 0) {
+    Offset += AsciiSPrint (Report + Offset, Size - Offset, "  Per output: %Lu ns\n",
+                DivU64x32 (GetTimeInNanoSecond (mTimings.EnumerationTicks), (UINT32)mDevicesCount));
+  }
+
+  for (h = 0; h < mTimings.HandleCount; h++) {
+    Offset += AsciiSPrint (Report + Offset, Size - Offset, "  Handle %lu: %Lu us (%lu outputs)\n",
+                h,
+                DivU64x32 (GetTimeInNanoSecond (mTimings.HandleTicks[h]), 1000),
+                mTimings.HandleOutputs[h]);
+  }
+
+  if (mTimings.MenuCount > 0) {
+    Offset += AsciiSPrint (Report + Offset, Size - Offset, "Menu round trip: %Lu us average over %lu\n",
+                DivU64x32 (GetTimeInNanoSecond (mTimings.MenuTicks), (UINT32)mTimings.MenuCount * 1000),
+                mTimings.MenuCount);
+  }
+
+  if (mTimings.FlushCount > 0) {
+    Offset += AsciiSPrint (Report + Offset, Size - Offset, "Key flush: %Lu ns average over %lu\n",
+                DivU64x32 (GetTimeInNanoSecond (mTimings.FlushTicks), (UINT32)mTimings.FlushCount),
+                mTimings.FlushCount);
+  }
+
+  // Image load time grows with its size, mostly the embedded sampler.
+  Status = gBS->HandleProtocol (gImageHandle, &gEfiLoadedImageProtocolGuid, (VOID **)&LoadedImage);
+  if (!EFI_ERROR (Status)) {
+    Offset += AsciiSPrint (Report + Offset, Size - Offset, "Image: %Lu bytes, sampler %lu bytes embedded\n", LoadedImage->ImageSize, mChimeDataLength);
+  }
+
+  if (mSource == NULL) {
+    Offset += AsciiSPrint (Report + Offset, Size - Offset, "Decode: not decoded yet\n");
+  } else {
+    Offset += AsciiSPrint (Report + Offset, Size - Offset, "Decode: %Lu us\n", DivU64x32 (GetTimeInNanoSecond (mTimings.DecodeTicks), 1000));
+  }
+
+  // Frames decoded so far, including those decoded during playback.
+  if (mMp3Stream.DecodedFrames > 0) {
+    Offset += AsciiSPrint (Report + Offset, Size - Offset, "MP3 frames: %lu decoded, %Lu ns per frame\n",
+                mMp3Stream.DecodedFrames,
+                DivU64x32 (GetTimeInNanoSecond (mMp3Stream.DecodeTicks), (UINT32)mMp3Stream.DecodedFrames));
+  }
+
+  if (mFileSource.ReadCount > 0) {
+    Offset += AsciiSPrint (Report + Offset, Size - Offset, "File reads: %lu, %Lu bytes, %Lu us\n",
+                mFileSource.ReadCount,
+                mFileSource.ReadBytes,
+                DivU64x32 (GetTimeInNanoSecond (mFileSource.ReadTicks), 1000));
+  }
+
+  if (mAdpcmSource.DecodedFrames > 0) {
+    Offset += AsciiSPrint (Report + Offset, Size - Offset, "ADPCM frames: %lu decoded, %Lu ns per frame\n",
+                mAdpcmSource.DecodedFrames,
+                DivU64x32 (GetTimeInNanoSecond (mAdpcmSource.DecodeTicks), (UINT32)mAdpcmSource.DecodedFrames));
+  }
+
+  // Frames produced by the last rate conversion.
+  if (mResampleSource.Frames > 0) {
+    Offset += AsciiSPrint (Report + Offset, Size - Offset, "Resampler: %Lu frames, %Lu ns per frame (%u/%u)\n",
+                mResampleSource.Frames,
+                DivU64x64Remainder (GetTimeInNanoSecond (mResampleSource.Ticks), mResampleSource.Frames, NULL),
+                mResampleSource.L,
+                mResampleSource.M);
+  }
+
+  *Length = Offset;
+
+  return Report;
+}
+
+STATIC
+EFI_STATUS
+PrintTimings (
+  VOID
+  )
+{
+  CHAR8     *Report;
+  UINTN     Length;
+
+  //
+
+  Report = FormatTimings (&Length);
+  if (Report == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  AsciiPrint ("%a", Report);
+  FreePool (Report);
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Append String to a JSON document as a quoted string. Characters outside
+  printable ASCII are replaced, so the output needs at most two bytes per
+  character plus quotes.
+**/
+STATIC
+UINTN
+AppendJsonString (
+  OUT CHAR8         *Buffer,
+  IN  UINTN         Size,
+  IN  CONST CHAR16  *String
+  )
+{
+  UINTN   Offset;
+
+  //
+
+  if (Size < 3) {
+    return 0;
+  }
+
+  Offset = 0;
+  Buffer[Offset++] = '"';
+  for (; (String != NULL) && (*String != L'\0') && ((Offset + 3) < Size); String++) {
+    if ((*String == L'"') || (*String == L'\\')) {
+      Buffer[Offset++] = '\\';
+      Buffer[Offset++] = (CHAR8)*String;
+    } else if ((*String < L' ') || (*String > L'~')) {
+      Buffer[Offset++] = '?';
+    } else {
+      Buffer[Offset++] = (CHAR8)*String;
+    }
+  }
+  Buffer[Offset++] = '"';
+  Buffer[Offset]   = '\0';
+
+  return Offset;
+}
+
+/**
+  Format all outputs with their supported formats and measured timings as
+  JSON, for collection without scraping the text dump. Sweep results are
+  included once a sweep ran.
+**/
+STATIC
+CHAR8 *
+FormatDevicesJson (
+  OUT UINTN   *Length
+  )
+{
+  CHAR8     *Report;
+  UINTN     Size;
+  UINTN     Offset;
+  UINTN     Handle;
+  UINTN     HandleOutputs;
+  UINTN     i;
+  UINTN     b;
+  CHAR8     *Separator;
+
+  //
+
+  Size = DEVICES_JSON_HEADER_SIZE;
+  for (i = 0; i < mDevicesCount; i++) {
+    Size += DEVICES_JSON_OUTPUT_SIZE + 2 * StrLen (mDevices[i].DevicePathText);
+  }
+
+  Report = AllocatePool (Size);
+  if (Report == NULL) {
+    return NULL;
+  }
+
+  Offset  = AsciiSPrint (Report, Size, "{\n  \"version\": %u,\n", DEVICES_JSON_VERSION);
+  Offset += AsciiSPrint (Report + Offset, Size - Offset,
+              "  \"timings\": {\"conin_us\": %Lu, \"enumeration_us\": %Lu, \"enumeration_cached\": %a, \"decode_us\": %Lu},\n",
+              DivU64x32 (GetTimeInNanoSecond (mTimings.ConInTicks), 1000),
+              DivU64x32 (GetTimeInNanoSecond (mTimings.EnumerationTicks), 1000),
+              mTimings.EnumerationCached ? "true" : "false",
+              DivU64x32 (GetTimeInNanoSecond (mTimings.DecodeTicks), 1000));
+  Offset += AsciiSPrint (Report + Offset, Size - Offset, "  \"outputs\": [");
+
+  // Outputs are listed in handle order, skipping handles without any.
+  Handle        = 0;
+  HandleOutputs = 0;
+  for (i = 0; i < mDevicesCount; i++) {
+    while ((Handle < mTimings.HandleCount) && (HandleOutputs >= mTimings.HandleOutputs[Handle])) {
+      Handle++;
+      HandleOutputs = 0;
+    }
+    HandleOutputs++;
+
+    Offset += AsciiSPrint (Report + Offset, Size - Offset, "%a\n    {\"index\": %lu, \"path\": ", (i > 0) ? "," : "", i + 1);
+    Offset += AppendJsonString (Report + Offset, Size - Offset, mDevices[i].DevicePathText);
+    Offset += AsciiSPrint (Report + Offset, Size - Offset,
+                ", \"port\": %lu, \"device\": \"%s\", \"location\": \"%s\", \"surface\": \"%s\", \"freqs\": [",
+                mDevices[i].OutputPortIndex,
+                mDefaultDevices[mDevices[i].OutputPort.Device],
+                mLocations[mDevices[i].OutputPort.Location],
+                mSurfaces[mDevices[i].OutputPort.Surface]);
+
+    Separator = "";
+    for (b = 0; b < 32; b++) {
+      if (((mDevices[i].OutputPort.SupportedFreqs & (1U << b)) != 0) && (AudioIoFreqToHz (1U << b) != 0)) {
+        Offset   += AsciiSPrint (Report + Offset, Size - Offset, "%a%u", Separator, AudioIoFreqToHz (1U << b));
+        Separator = ", ";
+      }
+    }
+
+    Offset   += AsciiSPrint (Report + Offset, Size - Offset, "], \"bits\": [");
+    Separator = "";
+    for (b = 0; b < ARRAY_SIZE (mBitsOrder); b++) {
+      if ((mDevices[i].OutputPort.SupportedBits & mBitsOrder[b]) != 0) {
+        Offset   += AsciiSPrint (Report + Offset, Size - Offset, "%a%u", Separator, AudioIoBitsToWidth (mBitsOrder[b]));
+        Separator = ", ";
+      }
+    }
+
+    Offset += AsciiSPrint (Report + Offset, Size - Offset, "], \"handle\": %lu, \"handle_us\": %Lu",
+                Handle,
+                (Handle < mTimings.HandleCount) ? DivU64x32 (GetTimeInNanoSecond (mTimings.HandleTicks[Handle]), 1000) : 0);
+
+    if (i < mSweepResultCount) {
+      Offset += AsciiSPrint (Report + Offset, Size - Offset, ", \"sweep\": {\"status\": \"%r\", \"setup_us\": %Lu, \"play_ms\": %Lu}",
+                  mSweepResults[i].Status,
+                  DivU64x32 (GetTimeInNanoSecond (mSweepResults[i].SetupTicks), 1000),
+                  DivU64x32 (GetTimeInNanoSecond (mSweepResults[i].PlayTicks), 1000000));
+    }
+
+    Offset += AsciiSPrint (Report + Offset, Size - Offset, "}");
+  }
+
+  Offset += AsciiSPrint (Report + Offset, Size - Offset, "\n  ]\n}\n");
+
+  *Length = Offset;
+
+  return Report;
+}
+
+STATIC
+EFI_STATUS
+DumpDevices (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  EFI_FILE_PROTOCOL           *Dir;
+  CHAR8                       *Report;
+  UINTN                       Length;
+
+  //
+
+  Status = OpenSelfDirectory (&Dir, EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE, TRUE);
+  if (Status == EFI_NOT_FOUND) {
+    return Status;
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = OcAudioDump (Dir);
+
+    Report = FormatTimings (&Length);
+    if (Report != NULL) {
+      SetFileData (Dir, TIMINGS_FILE_NAME, Report, (UINT32)Length);
+      FreePool (Report);
+    }
+
+    // Formatted in memory first, so the file is written in one go.
+    Report = FormatDevicesJson (&Length);
+    if (Report != NULL) {
+      SetFileData (Dir, DEVICES_JSON_FILE_NAME, Report, (UINT32)Length);
+      FreePool (Report);
+    }
+
+    Dir->Close (Dir);
+  }
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+PrintCurrentDevice (
+  VOID
+  )
+{
+  if (mCurrentDevice == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  // Success.
+  Print (L"Output: %s - %s %s (Port: %lu) - %s\n",
+    mDefaultDevices[mCurrentDevice->OutputPort.Device],
+    mLocations[mCurrentDevice->OutputPort.Location],
+    mSurfaces[mCurrentDevice->OutputPort.Surface],
+    mCurrentDevice->OutputPortIndex,
+    mCurrentDevice->DevicePathText);
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+PrintCurrentSetting (
+  VOID
+  )
+{
+  EFI_STATUS    Status;
+
+  //
+
+  Status = GetAudioDecoder ();
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Print (L"Volume: (%d)%s\n", mDeviceVolume, mSoftwareVolume ? L" software" : L"");
+  Print (L"Total devices: (%d)\n", mDevicesCount);
+  Print (L"Sampler: size (%d) freq (%d) bits (%d) chan (%d)\n", mBufferSize, mFrequency, mBits, mChannels);
+
+  Status = PrintCurrentDevice ();
+
+  return Status;
+}
+
+/**
+  Store the current output and volume for the next start.
+**/
+STATIC
+VOID
+StoreSettings (
+  VOID
+  )
+{
+  EFI_STATUS    Status;
+
+  //
+
+  if (mCurrentDevice == NULL) {
+    return;
+  }
+
+  Status = SettingsSave (mCurrentDevice, mDeviceVolume, mSoftwareVolume);
+  if (EFI_ERROR (Status)) {
+    Print (L"Failed to store settings - %r\n", Status);
+  }
+}
+
+STATIC
+EFI_STATUS
+SetCurrentDevice (
+  IN  UINTN   DeviceNumber
+  )
+{
+  // Device numbers are 1-based, as listed.
+  if ((mDevices == NULL) || (DeviceNumber == 0) || (DeviceNumber > mDevicesCount)) {
+    Print (L"The selected device is not valid.\n");
+    return EFI_INVALID_PARAMETER;
+  }
+
+  mCurrentDevice = &mDevices[DeviceNumber - 1];
+  StoreSettings ();
+
+  return PrintCurrentDevice ();
+}
+
+STATIC
+EFI_STATUS
+SelectDevice (
+  VOID
+  )
+{
+  EFI_STATUS    Status;
+  CHAR16        KeyValue;
+  BOOLEAN       Backspace;
+  CHAR16        CurrentBuffer[MAX_CHARS + 1];
+  UINTN         CurrentCharCount;
+  UINTN         DeviceIndex;
+
+  //
+
+  // Check that parameters are valid.
+  if ((mSimpleTextIn == NULL) || (mDevices == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  // We need a null terminator.
+  CurrentBuffer[MAX_CHARS] = 0;
+
+  // Prompt for device number.
+  CurrentCharCount = 0;
+
+  Print (L"Enter the device number (0-%lu): ", mDevicesCount);
+
+  while (TRUE) {
+    // Wait for key.
+    Status = WaitForKey (&KeyValue);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    Backspace = (KeyValue == L'\b');
+
+    // If we are backspacing, clear selection.
+    if ((CurrentCharCount != 0) && Backspace) {
+      CurrentCharCount--;
+      Print (L"\b \b");
+      continue;
+    }
+
+    // If enter, break out.
+    if (KeyValue == L'\r') {
+      break;
+    }
+
+    // If not a number, ignore.
+    if (!Backspace && ((KeyValue < L'0') || (KeyValue > '9'))) {
+      continue;
+    }
+
+    // If no selection, we don't want to backspace.
+    // If we are at the max, don't accept any more.
+    if (((CurrentCharCount == 0) && Backspace) || (CurrentCharCount >= MAX_CHARS)) {
+      continue;
+    }
+
+    // Get character.
+    CurrentBuffer[CurrentCharCount] = KeyValue;
+    Print (L"%c", CurrentBuffer[CurrentCharCount]);
+    CurrentCharCount++;
+  }
+  Print (L"\n");
+
+  // Clear out extra characters.
+  SetMem (CurrentBuffer + CurrentCharCount, MAX_CHARS - CurrentCharCount, 0);
+
+  // Get device index.
+  DeviceIndex = StrDecimalToUintn (CurrentBuffer);
+  if (DeviceIndex == 0) {
+    DeviceIndex = 1;
+  }
+
+  // An invalid selection is reported, but not fatal here.
+  Status = SetCurrentDevice (DeviceIndex);
+  if (Status == EFI_INVALID_PARAMETER) {
+    return EFI_SUCCESS;
+  }
+
+  return Status;
+}
+
+STATIC
+EFI_STATUS
+SetVolume (
+  IN  UINTN   Volume
+  )
+{
+  if (Volume > EFI_AUDIO_IO_PROTOCOL_MAX_VOLUME) {
+    Volume = EFI_AUDIO_IO_PROTOCOL_MAX_VOLUME;
+  }
+  mDeviceVolume = (UINT8)Volume;
+  StoreSettings ();
+
+  // Success.
+  Print (L"Volume set to %u\n", mDeviceVolume);
+
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+EFIAPI
+SelectVolume (
+  VOID
+  )
+{
+  EFI_STATUS    Status;
+  CHAR16        KeyValue;
+  BOOLEAN       Backspace;
+  CHAR16        CurrentBuffer[MAX_CHARS + 1];
+  UINTN         CurrentCharCount;
+  UINTN         Volume;
+
+  //
+
+  // Check that parameters are valid.
+  if (mSimpleTextIn == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  // We need a null terminator.
+  CurrentBuffer[MAX_CHARS] = 0;
+
+  // Prompt for device number.
+  CurrentCharCount = 0;
+
+  Print (L"Enter the desired volume (0-100): ");
+
+  while (TRUE) {
+    // Wait for key.
+    Status = WaitForKey (&KeyValue);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    Backspace = (KeyValue == L'\b');
+
+    // If we are backspacing, clear selection.
+    if ((CurrentCharCount != 0) && Backspace) {
+      CurrentCharCount--;
+      Print (L"\b \b");
+      continue;
+    }
+
+    // If enter, break out.
+    if (KeyValue == L'\r') {
+      break;
+    }
+
+    // If not a number, ignore.
+    if (!Backspace && ((KeyValue < L'0') || (KeyValue > '9'))) {
+      continue;
+    }
+
+    // If no selection, we don't want to backspace.
+    // If we are at the max, don't accept any more.
+    if (((CurrentCharCount == 0) && Backspace) || (CurrentCharCount >= MAX_CHARS)) {
+      continue;
+    }
+
+    // Get character.
+    CurrentBuffer[CurrentCharCount] = KeyValue;
+    Print (L"%c", CurrentBuffer[CurrentCharCount]);
+    CurrentCharCount++;
+  }
+  Print (L"\n");
+
+  // Clear out extra characters.
+  SetMem (CurrentBuffer + CurrentCharCount, MAX_CHARS - CurrentCharCount, 0);
+
+  // Get volume.
+  Volume = StrDecimalToUintn (CurrentBuffer);
+
+  return SetVolume (Volume);
+}
+
+STATIC
+VOID
+PrintProgress (
+  IN  AUDIO_STREAM  *Stream,
+  IN  UINT64        StartTicks
+  )
+{
+  UINT64    Elapsed;
+
+  //
+
+  // Estimate played samples from wall time, bounded by what was submitted.
+  Elapsed = DivU64x32 (
+              MultU64x32 (GetTimeInNanoSecond (GetPerformanceCounter () - StartTicks), AudioIoFreqToHz (Stream->Source->Frequency)),
+              1000000000
+              );
+  if (Elapsed > Stream->SubmittedSamples) {
+    Elapsed = Stream->SubmittedSamples;
+  }
+
+  Print (L"\rPlayed %lu/%lu samples", (UINTN)Elapsed, Stream->Source->TotalSamples);
+}
+
+/**
+  Stream source to the device, already set up for its format.
+  Returns EFI_ABORTED when cancelled with Esc.
+**/
+STATIC
+EFI_STATUS
+PlaySampler (
+  IN  EFI_AUDIO_IO_PROTOCOL   *AudioIo,
+  IN  AUDIO_SOURCE            *Source
+  )
+{
+  EFI_STATUS      Status;
+  AUDIO_STREAM    Stream;
+  EFI_EVENT       Events[3];
+  UINTN           EventCount;
+  UINTN           EventIndex;
+  BOOLEAN         Cancelled;
+  UINT64          StartTicks;
+
+  //
+
+  Status = AudioStreamCreate (&Stream, AudioIo, Source);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  // Buffer refill, progress refresh and, when there is a console, keys.
+  Events[0] = Stream.RefillEvent;
+
+  Status = gBS->CreateEvent (EVT_TIMER, 0, NULL, NULL, &Events[1]);
+  if (EFI_ERROR (Status)) {
+    AudioStreamDestroy (&Stream);
+    return Status;
+  }
+  gBS->SetTimer (Events[1], TimerPeriodic, PROGRESS_INTERVAL);
+
+  EventCount = 2;
+  if (mSimpleTextIn != NULL) {
+    Events[EventCount++] = mSimpleTextIn->WaitForKey;
+  }
+
+  Cancelled       = FALSE;
+  mCancelPending  = FALSE;
+  StartTicks      = GetPerformanceCounter ();
+
+  while (TRUE) {
+    Status = AudioStreamService (&Stream);
+    if (EFI_ERROR (Status) || AudioStreamIsDone (&Stream)) {
+      break;
+    }
+
+    gBS->WaitForEvent (EventCount, Events, &EventIndex);
+
+    if (EventIndex == 1) {
+      PrintProgress (&Stream, StartTicks);
+    } else if (EventIndex == 2) {
+      //
+      // Other keys are kept as type-ahead. Esc fades playback out, then lets
+      // the stream drain. Keys are left with the console once the queue is
+      // full, so stop waiting on them then.
+      //
+      if (PollCancelKey ()) {
+        AudioStreamFadeOut (&Stream);
+        Cancelled   = TRUE;
+        EventCount  = 2;
+      } else if (mKeyQueueCount == KEY_QUEUE_SIZE) {
+        EventCount  = 2;
+      }
+    }
+  }
+
+  if (!Cancelled && !EFI_ERROR (Status)) {
+    // Totals are estimates for some sources, only the count played is exact. Pad over the progress line.
+    Print (L"\rPlayed %lu samples%12a", Stream.PlayedSamples, "");
+  }
+  Print (L"\n");
+
+  gBS->SetTimer (Events[1], TimerCancel, 0);
+  gBS->CloseEvent (Events[1]);
+  AudioStreamDestroy (&Stream);
+
+  if (Cancelled) {
+    Print (L"Playback cancelled.\n");
+    return EFI_ABORTED;
+  }
+
+  return Status;
+}
+
+/**
+  Pick the output rate for the sampler on a port: the sampler rate when
+  advertised, otherwise the nearest advertised one, preferring higher ones.
+**/
+STATIC
+VOID
+PickOutputRate (
+  IN  EFI_AUDIO_IO_PROTOCOL_PORT  *OutputPort,
+  OUT EFI_AUDIO_IO_PROTOCOL_FREQ  *Frequency
+  )
+{
+  UINT32    Hz;
+  UINT32    Candidate;
+  UINT32    Distance;
+  UINT32    BestDistance;
+  UINT32    i;
+
+  //
+
+  *Frequency = mFrequency;
+
+  if ((OutputPort->SupportedFreqs & mFrequency) != 0) {
+    return;
+  }
+
+  // Rates ascend with their bits, so ties go to the later, higher one.
+  Hz            = AudioIoFreqToHz (mFrequency);
+  BestDistance  = MAX_UINT32;
+  for (i = 0; i < 32; i++) {
+    Candidate = AudioIoFreqToHz ((EFI_AUDIO_IO_PROTOCOL_FREQ)(OutputPort->SupportedFreqs & (1U << i)));
+    if (Candidate == 0) {
+      continue;
+    }
+
+    Distance = (Candidate > Hz) ? (Candidate - Hz) : (Hz - Candidate);
+    if (Distance <= BestDistance) {
+      BestDistance  = Distance;
+      *Frequency    = (EFI_AUDIO_IO_PROTOCOL_FREQ)(1U << i);
+    }
+  }
+}
+
+/**
+  Pick the output format for the sampler on a port at a given rate: the
+  sampler format when advertised, otherwise the nearest advertised width,
+  preferring wider ones, in stereo.
+**/
+STATIC
+VOID
+PickOutputFormat (
+  IN  EFI_AUDIO_IO_PROTOCOL_PORT  *OutputPort,
+  IN  EFI_AUDIO_IO_PROTOCOL_FREQ  Frequency,
+  OUT EFI_AUDIO_IO_PROTOCOL_BITS  *Bits,
+  OUT UINT8                       *Channels
+  )
+{
+  UINTN   Index;
+  UINTN   i;
+
+  //
+
+  *Bits     = mBits;
+  *Channels = MIN (mChannels, AUDIO_OUTPUT_MAX_CHANNELS);
+
+  if (IsFormatSupported (OutputPort, Frequency, mBits)) {
+    return;
+  }
+
+  for (Index = 0; (Index < ARRAY_SIZE (mBitsOrder)) && (mBitsOrder[Index] != mBits); Index++);
+
+  for (i = Index + 1; i < ARRAY_SIZE (mBitsOrder); i++) {
+    if (IsFormatSupported (OutputPort, Frequency, mBitsOrder[i])) {
+      *Bits     = mBitsOrder[i];
+      *Channels = AUDIO_OUTPUT_MAX_CHANNELS;
+      return;
+    }
+  }
+
+  for (i = MIN (Index, ARRAY_SIZE (mBitsOrder)); i > 0; i--) {
+    if (IsFormatSupported (OutputPort, Frequency, mBitsOrder[i - 1])) {
+      *Bits     = mBitsOrder[i - 1];
+      *Channels = AUDIO_OUTPUT_MAX_CHANNELS;
+      return;
+    }
+  }
+}
+
+/**
+  Render a converting source chain into a new memory source. The cached copy
+  is only replaced once rendering succeeds, and dropped when it fails, as the
+  converters may have been set up for the new format already.
+**/
+STATIC
+EFI_STATUS
+RenderConvertedSampler (
+  IN  AUDIO_SOURCE  *Source
+  )
+{
+  EFI_STATUS    Status;
+  UINT8         *Buffer;
+  UINTN         Length;
+  UINTN         Offset;
+  UINTN         ReadLength;
+
+  //
+
+  Offset  = 0;
+  Length  = Source->TotalSamples * Source->Channels * AudioIoBytesPerSample (Source->Bits);
+  Buffer  = AllocatePool (Length);
+  if (Buffer == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto DONE;
+  }
+
+  Status = Source->Rewind (Source);
+  if (EFI_ERROR (Status)) {
+    goto DONE;
+  }
+
+  for (Offset = 0; Offset < Length; Offset += ReadLength) {
+    Status = Source->Read (Source, Buffer + Offset, Length - Offset, &ReadLength);
+    if (Status == EFI_END_OF_FILE) {
+      Status = EFI_SUCCESS;
+      break;
+    }
+
+    if (EFI_ERROR (Status)) {
+      goto DONE;
+    }
+  }
+
+  DONE:
+
+  // Any scaled copy is of the old buffer.
+  if (mConvertedBuffer != NULL) {
+    FreePool (mConvertedBuffer);
+    mConvertedBuffer  = NULL;
+    mScaledData       = NULL;
+  }
+
+  if (EFI_ERROR (Status)) {
+    if (Buffer != NULL) {
+      FreePool (Buffer);
+    }
+
+    mConvertedFreq      = 0;
+    mConvertedBits      = 0;
+    mConvertedChannels  = 0;
+    return Status;
+  }
+
+  mConvertedBuffer    = Buffer;
+  MemorySourceInit (&mConvertedSource, mConvertedBuffer, Offset, Source->Frequency, Source->Bits, Source->Channels);
+  mConvertedFreq      = Source->Frequency;
+  mConvertedBits      = Source->Bits;
+  mConvertedChannels  = Source->Channels;
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Get source and device volume for a test of the sampler on a port.
+
+  The sampler is resampled to an advertised rate and converted to an
+  advertised format as needed. Samplers held in memory are converted once
+  into a cached copy, reused while the format stays the same. Streamed ones
+  are converted as they are read.
+
+  With software volume, the device plays at full volume and samples are
+  scaled instead, again once per volume level for samplers held in memory.
+**/
+STATIC
+EFI_STATUS
+GetTestSource (
+  IN  EFI_AUDIO_IO_PROTOCOL_PORT  *OutputPort,
+  OUT AUDIO_SOURCE                **Source,
+  OUT UINT8                       *DeviceVolume
+  )
+{
+  EFI_STATUS                  Status;
+  EFI_AUDIO_IO_PROTOCOL_FREQ  Freq;
+  EFI_AUDIO_IO_PROTOCOL_BITS  Bits;
+  UINT8                       Channels;
+  MEMORY_SOURCE               *Memory;
+
+  //
+
+  *Source       = mSource;
+  *DeviceVolume = mDeviceVolume;
+  Memory        = (mSource == &mMemorySource.Source) ? &mMemorySource : NULL;
+
+  PickOutputRate (OutputPort, &Freq);
+  PickOutputFormat (OutputPort, Freq, &Bits, &Channels);
+  if ((Freq != mFrequency) || (Bits != mBits) || (Channels != mChannels)) {
+    if ((Memory == NULL) || (mConvertedBuffer == NULL)
+      || (mConvertedFreq != Freq) || (mConvertedBits != Bits) || (mConvertedChannels != Channels)) {
+      if (Freq != mFrequency) {
+        ResampleSourceFree (&mResampleSource);
+        Status = ResampleSourceInit (&mResampleSource, *Source, Freq);
+        if (EFI_ERROR (Status)) {
+          return Status;
+        }
+
+        *Source = &mResampleSource.Source;
+      }
+
+      if ((Bits != mBits) || (Channels != mChannels)) {
+        ConvertSourceFree (&mConvertSource);
+        Status = ConvertSourceInit (&mConvertSource, *Source, Bits, Channels);
+        if (EFI_ERROR (Status)) {
+          return Status;
+        }
+
+        *Source = &mConvertSource.Source;
+      }
+
+      if (Memory != NULL) {
+        Status = RenderConvertedSampler (*Source);
+        if (EFI_ERROR (Status)) {
+          return Status;
+        }
+      }
+    }
+
+    if (Memory != NULL) {
+      Memory  = &mConvertedSource;
+      *Source = &Memory->Source;
+    }
+  }
+
+  if (!mSoftwareVolume) {
+    return EFI_SUCCESS;
+  }
+
+  *DeviceVolume = EFI_AUDIO_IO_PROTOCOL_MAX_VOLUME;
+
+  if (Memory == NULL) {
+    GainSourceInit (&mGainSource, *Source, GainFromVolume (mDeviceVolume));
+    *Source = &mGainSource.Source;
+    return EFI_SUCCESS;
+  }
+
+  if ((mScaledBuffer == NULL) || (mScaledData != Memory->Data) || (mScaledVolume != mDeviceVolume)) {
+    if ((mScaledBuffer == NULL) || (mScaledData != Memory->Data)) {
+      if (mScaledBuffer != NULL) {
+        FreePool (mScaledBuffer);
+      }
+
+      mScaledData   = NULL;
+      mScaledBuffer = AllocatePool (Memory->Length);
+      if (mScaledBuffer == NULL) {
+        return EFI_OUT_OF_RESOURCES;
+      }
+    }
+
+    CopyMem (mScaledBuffer, Memory->Data, Memory->Length);
+    GainApply (mScaledBuffer, Memory->Length, Memory->Source.Bits, GainFromVolume (mDeviceVolume));
+    MemorySourceInit (&mScaledSource, mScaledBuffer, Memory->Length, Memory->Source.Frequency, Memory->Source.Bits, Memory->Source.Channels);
+    mScaledData   = Memory->Data;
+    mScaledVolume = mDeviceVolume;
+  }
+
+  *Source = &mScaledSource.Source;
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+SetSoftwareVolume (
+  IN  BOOLEAN   Enable
+  )
+{
+  mSoftwareVolume = Enable;
+  StoreSettings ();
+
+  Print (L"Software volume %s\n", mSoftwareVolume ? L"enabled" : L"disabled");
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+TestOutput (
+  VOID
+  )
+{
+  EFI_STATUS              Status;
+  EFI_AUDIO_IO_PROTOCOL   *AudioIo;
+  UINTN                   OutputIndex;
+  AUDIO_SOURCE            *Source;
+  UINT8                   Volume;
+
+  //
+
+  if (mCurrentDevice == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  AudioIo     = mCurrentDevice->AudioIo;
+  OutputIndex = mCurrentDevice->OutputPortIndex;
+
+  Status = GetAudioDecoder ();
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = GetTestSource (&mCurrentDevice->OutputPort, &Source, &Volume);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if (!IsFormatSupported (&mCurrentDevice->OutputPort, Source->Frequency, Source->Bits)) {
+    Print (L"Sampler format is not advertised by this output.\n");
+  } else if ((Source->Frequency != mFrequency) || (Source->Bits != mBits) || (Source->Channels != mChannels)) {
+    Print (L"Sampler converted to %u Hz %u-bit %u channel(s).\n", AudioIoFreqToHz (Source->Frequency), AudioIoBitsToWidth (Source->Bits), Source->Channels);
+  }
+
+  // Setup playback.
+  Print (L"Playing back audio...\n");
+
+  Status = AudioIo->SetupPlayback (AudioIo, (UINT8)OutputIndex, Volume, Source->Frequency, Source->Bits, Source->Channels);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  // Play chime.
+  if (mSimpleTextIn != NULL) {
+    Print (L"Press Esc to stop.\n");
+  }
+
+  Status = PlaySampler (AudioIo, Source);
+  if (Status == EFI_ABORTED) {
+    return EFI_SUCCESS;
+  }
+
+  return Status;
+}
+
+STATIC
+CHAR8 *
+FormatSweep (
+  IN  CONST SWEEP_RESULT  *Results,
+  IN  UINTN               ResultCount,
+  OUT UINTN               *Length
+  )
+{
+  CHAR8     *Report;
+  UINTN     Size;
+  UINTN     Offset;
+  UINTN     i;
+
+  //
+
+  Size    = (ResultCount + 2) * SWEEP_REPORT_LINE_SIZE;
+  Report  = AllocatePool (Size);
+  if (Report == NULL) {
+    return NULL;
+  }
+
+  Offset = AsciiSPrint (Report, Size, "Output  Setup (us)  Play (ms)  Status                Device\n");
+
+  for (i = 0; i < ResultCount; i++) {
+    Offset += AsciiSPrint (Report + Offset, Size - Offset, "%6lu  %10Lu  %9Lu  %-20r  %s %s %s (Port: %lu) - %s\n",
+                i + 1,
+                DivU64x32 (GetTimeInNanoSecond (Results[i].SetupTicks), 1000),
+                DivU64x32 (GetTimeInNanoSecond (Results[i].PlayTicks), 1000000),
+                Results[i].Status,
+                mDefaultDevices[mDevices[i].OutputPort.Device],
+                mLocations[mDevices[i].OutputPort.Location],
+                mSurfaces[mDevices[i].OutputPort.Surface],
+                mDevices[i].OutputPortIndex,
+                mDevices[i].DevicePathText);
+  }
+
+  *Length = Offset;
+
+  return Report;
+}
+
+/**
+  Play a short clip on every output in turn, recording setup latency,
+  playback duration and status of each. Esc ends the sweep early.
+**/
+STATIC
+EFI_STATUS
+SweepOutputs (
+  VOID
+  )
+{
+  EFI_STATUS              Status;
+  SWEEP_RESULT            *Results;
+  UINTN                   ResultCount;
+  EFI_AUDIO_IO_PROTOCOL   *AudioIo;
+  AUDIO_SOURCE            *Source;
+  UINT8                   Volume;
+  LIMITED_SOURCE          Clip;
+  EFI_FILE_PROTOCOL       *Dir;
+  CHAR8                   *Report;
+  UINTN                   Length;
+  UINTN                   Played;
+  UINTN                   i;
+  UINT64                  StartTicks;
+
+  //
+
+  if (mDevices == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Status = GetAudioDecoder ();
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Results = AllocateZeroPool (mDevicesCount * sizeof (SWEEP_RESULT));
+  if (Results == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  if (mSimpleTextIn != NULL) {
+    Print (L"Press Esc to stop the sweep.\n");
+  }
+
+  Played = 0;
+  for (ResultCount = 0; ResultCount < mDevicesCount; ResultCount++) {
+    i       = ResultCount;
+    AudioIo = mDevices[i].AudioIo;
+
+    Print (L"Output %lu: %s %s %s (Port: %lu)\n",
+      i + 1,
+      mDefaultDevices[mDevices[i].OutputPort.Device],
+      mLocations[mDevices[i].OutputPort.Location],
+      mSurfaces[mDevices[i].OutputPort.Surface],
+      mDevices[i].OutputPortIndex);
+
+    Status = GetTestSource (&mDevices[i].OutputPort, &Source, &Volume);
+    if (EFI_ERROR (Status)) {
+      Results[i].Status = Status;
+      continue;
+    }
+
+    StartTicks  = GetPerformanceCounter ();
+    Status      = AudioIo->SetupPlayback (AudioIo, (UINT8)mDevices[i].OutputPortIndex, Volume, Source->Frequency, Source->Bits, Source->Channels);
+    Results[i].SetupTicks = GetPerformanceCounter () - StartTicks;
+    if (EFI_ERROR (Status)) {
+      Results[i].Status = Status;
+      Print (L"Setup failed - %r\n", Status);
+      continue;
+    }
+
+    LimitedSourceInit (&Clip, Source, (UINTN)DivU64x32 (MultU64x32 (AudioIoFreqToHz (Source->Frequency), SWEEP_CLIP_LENGTH), 1000));
+
+    StartTicks            = GetPerformanceCounter ();
+    Status                = PlaySampler (AudioIo, &Clip.Source);
+    Results[i].PlayTicks  = GetPerformanceCounter () - StartTicks;
+    Results[i].Status     = Status;
+
+    if (Status == EFI_ABORTED) {
+      ResultCount++;
+      break;
+    }
+
+    if (!EFI_ERROR (Status)) {
+      Played++;
+    }
+  }
+
+  Report = FormatSweep (Results, ResultCount, &Length);
+
+  // Kept for the structured dump.
+  if (mSweepResults != NULL) {
+    FreePool (mSweepResults);
+  }
+  mSweepResults     = Results;
+  mSweepResultCount = ResultCount;
+
+  if (Report == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Print (L"\n");
+  AsciiPrint ("%a", Report);
+
+  // Keep the table next to the dumps, if possible.
+  if (!EFI_ERROR (OpenSelfDirectory (&Dir, EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE, TRUE))) {
+    Status = SetFileData (Dir, SWEEP_FILE_NAME, Report, (UINT32)Length);
+    if (EFI_ERROR (Status)) {
+      Print (L"Failed to write %s - %r\n", SWEEP_FILE_NAME, Status);
+    }
+    Dir->Close (Dir);
+  }
+
+  FreePool (Report);
+
+  // Sweep fails only when no output could play at all.
+  return (Played > 0) ? EFI_SUCCESS : EFI_DEVICE_ERROR;
+}
+
+STATIC
+VOID
+DisplayMenu (
+  VOID
+  )
+{
+  // Clear screen.
+  if (gST->ConOut != NULL) {
+    gST->ConOut->ClearScreen (gST->ConOut);
+  }
+
+  // Print menu.
+  Print (L"\n");
+  Print (L"Configures the AudioDxe EFI driver.\n");
+  Print (L"=========================================\n");
+  Print (L"%c - List all audio outputs\n", BCFG_ARG_LIST);
+  Print (L"%c - Dump audio outputs to file\n", BCFG_ARG_DUMP);
+  Print (L"%c - Select audio output\n", BCFG_ARG_SELECT);
+  Print (L"%c - Show current setting\n", BCFG_ARG_CURR);
+  Print (L"%c - Change volume\n", BCFG_ARG_VOLUME);
+  Print (L"%c - Toggle software volume\n", BCFG_ARG_GAIN);
+  Print (L"%c - Test current audio output\n", BCFG_ARG_TEST);
+  Print (L"%c - Test all audio outputs in turn\n", BCFG_ARG_SWEEP);
+  Print (L"%c - Test audio outputs at once\n", BCFG_ARG_ALL);
+  Print (L"%c - Play test signal on current audio output\n", BCFG_ARG_SIGNAL);
+  Print (L"%c - Show timing profile\n", BCFG_ARG_PERF);
+  Print (L"%c - Quit\n", BCFG_ARG_QUIT);
+  Print (L"\n");
+  Print (L"Enter an option: ");
+}
+
+// Equal tempered semitones within an octave, in 16.16 fixed point.
+STATIC CONST UINT32 mSemitoneRatios[] = {
+  65536, 69433, 73562, 77936, 82570, 87480, 92682, 98193, 104032, 110218, 116772, 123715
+};
+
+// Tone sample rates, by preference.
+STATIC CONST EFI_AUDIO_IO_PROTOCOL_FREQ mToneFreqs[] = {
+  EfiAudioIoFreq48kHz, EfiAudioIoFreq44kHz, EfiAudioIoFreq96kHz, EfiAudioIoFreq32kHz, EfiAudioIoFreq88kHz,
+  EfiAudioIoFreq192kHz, EfiAudioIoFreq22kHz, EfiAudioIoFreq16kHz, EfiAudioIoFreq11kHz, EfiAudioIoFreq8kHz
+};
+
+// Tone sample widths, by preference.
+STATIC CONST EFI_AUDIO_IO_PROTOCOL_BITS mToneBits[] = {
+  EfiAudioIoBits16, EfiAudioIoBits24, EfiAudioIoBits32, EfiAudioIoBits20
+};
+
+/**
+  Pick the preferred format for generated signals that a port advertises.
+**/
+STATIC
+EFI_STATUS
+PickToneFormat (
+  IN  EFI_AUDIO_IO_PROTOCOL_PORT  *OutputPort,
+  OUT EFI_AUDIO_IO_PROTOCOL_FREQ  *Frequency,
+  OUT EFI_AUDIO_IO_PROTOCOL_BITS  *Bits
+  )
+{
+  UINTN   f;
+  UINTN   b;
+
+  //
+
+  for (f = 0; f < ARRAY_SIZE (mToneFreqs); f++) {
+    for (b = 0; b < ARRAY_SIZE (mToneBits); b++) {
+      if (IsFormatSupported (OutputPort, mToneFreqs[f], mToneBits[b])) {
+        *Frequency  = mToneFreqs[f];
+        *Bits       = mToneBits[b];
+        return EFI_SUCCESS;
+      }
+    }
+  }
+
+  return EFI_UNSUPPORTED;
+}
+
+/**
+  Get a tone some semitones above the base tone of parallel tests.
+**/
+STATIC
+UINT32
+ParallelSemitoneHz (
+  IN  UINTN   Semitone
+  )
+{
+  return ((PARALLEL_TONE_BASE_HZ * mSemitoneRatios[Semitone % ARRAY_SIZE (mSemitoneRatios)]) >> 16) << (Semitone / ARRAY_SIZE (mSemitoneRatios));
+}
+
+/**
+  Get the tone of an output in a parallel test, distinct for as many outputs
+  as there are semitones between the base tone and the Nyquist limit of the
+  rate. Whole tones come first and then the semitones between them, so the
+  first outputs stay easy to tell apart by ear.
+**/
+STATIC
+UINT32
+GetParallelToneHz (
+  IN  UINTN   ToneIndex,
+  IN  UINT32  RateHz
+  )
+{
+  UINTN   Range;
+  UINTN   Steps;
+  UINTN   Semitone;
+
+  //
+
+  for (Range = 0; ParallelSemitoneHz (Range) < (RateHz / 2); Range++);
+  if (Range == 0) {
+    return PARALLEL_TONE_BASE_HZ;
+  }
+
+  Steps     = (Range + 1) / 2;
+  Semitone  = ToneIndex % Range;
+  Semitone  = (Semitone < Steps) ? (2 * Semitone) : (2 * (Semitone - Steps) + 1);
+
+  return ParallelSemitoneHz (Semitone);
+}
+
+/**
+  Start a tone on one output of a parallel test.
+**/
+STATIC
+EFI_STATUS
+StartParallelOutput (
+  IN OUT PARALLEL_OUTPUT  *Output
+  )
+{
+  EFI_STATUS                  Status;
+  AUDIO_DEVICE                *Device;
+  EFI_AUDIO_IO_PROTOCOL_FREQ  Freq;
+  EFI_AUDIO_IO_PROTOCOL_BITS  Bits;
+  AUDIO_SOURCE                *Source;
+  UINT8                       Volume;
+
+  //
+
+  Device = &mDevices[Output->DeviceIndex];
+
+  Status = PickToneFormat (&Device->OutputPort, &Freq, &Bits);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = ToneSourceInit (&Output->Tone, Freq, Bits, 2, ToneSignalSine, Output->ToneHz, PARALLEL_TONE_LENGTH);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Source = &Output->Tone.Source;
+  Volume = mDeviceVolume;
+  if (mSoftwareVolume) {
+    GainSourceInit (&Output->Gain, Source, GainFromVolume (mDeviceVolume));
+    Source = &Output->Gain.Source;
+    Volume = EFI_AUDIO_IO_PROTOCOL_MAX_VOLUME;
+  }
+
+  Status = Device->AudioIo->SetupPlayback (Device->AudioIo, (UINT8)Device->OutputPortIndex, Volume, Freq, Bits, 2);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = AudioStreamCreate (&Output->Stream, Device->AudioIo, Source);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = AudioStreamService (&Output->Stream);
+  if (EFI_ERROR (Status)) {
+    AudioStreamDestroy (&Output->Stream);
+  }
+
+  return Status;
+}
+
+/**
+  Play a distinct tone on all selected outputs at once.
+
+  Audio I/O instances drive one output at a time, so outputs sharing a codec
+  are played in successive rounds, all codecs in parallel within each.
+**/
+STATIC
+EFI_STATUS
+PlayParallel (
+  IN OUT BOOLEAN  *Selected
+  )
+{
+  EFI_STATUS                  Status;
+  PARALLEL_OUTPUT             *Outputs;
+  UINTN                       *Active;
+  UINTN                       ActiveCount;
+  EFI_EVENT                   *Events;
+  UINTN                       EventIndex;
+  BOOLEAN                     Cancelled;
+  BOOLEAN                     Busy;
+  UINTN                       Played;
+  UINTN                       ToneIndex;
+  EFI_AUDIO_IO_PROTOCOL_FREQ  Freq;
+  EFI_AUDIO_IO_PROTOCOL_BITS  Bits;
+  UINTN                       i;
+  UINTN                       a;
+
+  //
+
+  Outputs = AllocateZeroPool (mDevicesCount * sizeof (PARALLEL_OUTPUT));
+  Active  = AllocatePool (mDevicesCount * sizeof (UINTN));
+  Events  = AllocatePool ((mDevicesCount + 1) * sizeof (EFI_EVENT));
+  if ((Outputs == NULL) || (Active == NULL) || (Events == NULL)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto DONE;
+  }
+
+  // Assign tones.
+  ToneIndex = 0;
+  for (i = 0; i < mDevicesCount; i++) {
+    Outputs[i].DeviceIndex  = i;
+    Outputs[i].Status       = EFI_NOT_STARTED;
+    if (Selected[i]) {
+      // Outputs without a tone format fail again once started, and report it then.
+      Freq = EfiAudioIoFreq48kHz;
+      PickToneFormat (&mDevices[i].OutputPort, &Freq, &Bits);
+      Outputs[i].ToneHz = GetParallelToneHz (ToneIndex++, AudioIoFreqToHz (Freq));
+      Print (L"Output %lu: %u Hz - %s %s %s (Port: %lu)\n",
+        i + 1,
+        Outputs[i].ToneHz,
+        mDefaultDevices[mDevices[i].OutputPort.Device],
+        mLocations[mDevices[i].OutputPort.Location],
+        mSurfaces[mDevices[i].OutputPort.Surface],
+        mDevices[i].OutputPortIndex);
+    }
+  }
+
+  if (mSimpleTextIn != NULL) {
+    Print (L"Press Esc to stop.\n");
+  }
+
+  Cancelled = FALSE;
+  do {
+    // Start the next selected output of every codec.
+    ActiveCount = 0;
+    for (i = 0; i < mDevicesCount; i++) {
+      if (!Selected[i]) {
+        continue;
+      }
+
+      for (a = 0; a < ActiveCount; a++) {
+        if (mDevices[Active[a]].AudioIo == mDevices[i].AudioIo) {
+          break;
+        }
+      }
+      if (a < ActiveCount) {
+        continue;
+      }
+
+      Selected[i]       = FALSE;
+      Outputs[i].Status = StartParallelOutput (&Outputs[i]);
+      if (!EFI_ERROR (Outputs[i].Status)) {
+        Events[ActiveCount]   = Outputs[i].Stream.RefillEvent;
+        Active[ActiveCount++] = i;
+      }
+    }
+
+    if (ActiveCount == 0) {
+      continue;
+    }
+
+    Print (L"Playing %lu output(s)...\n", ActiveCount);
+
+    EventIndex = ActiveCount;
+    if (mSimpleTextIn != NULL) {
+      Events[EventIndex++] = mSimpleTextIn->WaitForKey;
+    }
+
+    // Service all streams until every one is done.
+    while (TRUE) {
+      Busy = FALSE;
+      for (a = 0; a < ActiveCount; a++) {
+        if (AudioStreamIsDone (&Outputs[Active[a]].Stream)) {
+          continue;
+        }
+
+        Status = AudioStreamService (&Outputs[Active[a]].Stream);
+        if (EFI_ERROR (Status)) {
+          Outputs[Active[a]].Status = Status;
+          AudioStreamStop (&Outputs[Active[a]].Stream);
+        } else {
+          Busy = TRUE;
+        }
+      }
+
+      if (!Busy) {
+        break;
+      }
+
+      gBS->WaitForEvent (
+        ((mSimpleTextIn != NULL) && !Cancelled && (mKeyQueueCount < KEY_QUEUE_SIZE)) ? ActiveCount + 1 : ActiveCount,
+        Events,
+        &EventIndex
+        );
+
+      // Other keys are kept as type-ahead, Esc fades all outputs out, then lets them drain.
+      if ((EventIndex == ActiveCount) && PollCancelKey ()) {
+        for (a = 0; a < ActiveCount; a++) {
+          Outputs[Active[a]].Status = EFI_ABORTED;
+          AudioStreamFadeOut (&Outputs[Active[a]].Stream);
+        }
+        Cancelled = TRUE;
+      }
+    }
+
+    for (a = 0; a < ActiveCount; a++) {
+      AudioStreamDestroy (&Outputs[Active[a]].Stream);
+    }
+  } while ((ActiveCount > 0) && !Cancelled);
+
+  // Summary.
+  Played = 0;
+  Print (L"\n");
+  for (i = 0; i < mDevicesCount; i++) {
+    if (Outputs[i].ToneHz == 0) {
+      continue;
+    }
+
+    if (!EFI_ERROR (Outputs[i].Status)) {
+      Played++;
+    }
+    Print (L"Output %lu: %u Hz - %r\n", i + 1, Outputs[i].ToneHz, Outputs[i].Status);
+  }
+
+  Status = (Played > 0) ? EFI_SUCCESS : EFI_DEVICE_ERROR;
+
+  DONE:
+
+  if (Events != NULL) {
+    FreePool (Events);
+  }
+
+  if (Active != NULL) {
+    FreePool (Active);
+  }
+
+  if (Outputs != NULL) {
+    FreePool (Outputs);
+  }
+
+  return Status;
+}
+
+/**
+  Prompt for outputs to play in parallel, all of them when none are given.
+**/
+STATIC
+EFI_STATUS
+TestParallel (
+  VOID
+  )
+{
+  EFI_STATUS    Status;
+  CHAR16        KeyValue;
+  BOOLEAN       Backspace;
+  CHAR16        CurrentBuffer[MAX_LIST_CHARS + 1];
+  UINTN         CurrentCharCount;
+  BOOLEAN       *Selected;
+  BOOLEAN       Any;
+  UINTN         Number;
+  UINTN         i;
+
+  //
+
+  if (mDevices == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  CurrentCharCount = 0;
+
+  if (mSimpleTextIn != NULL) {
+    Print (L"Enter the device numbers (1-%lu), or none for all: ", mDevicesCount);
+
+    while (TRUE) {
+      // Wait for key.
+      Status = WaitForKey (&KeyValue);
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+
+      Backspace = (KeyValue == L'\b');
+
+      // If we are backspacing, clear selection.
+      if ((CurrentCharCount != 0) && Backspace) {
+        CurrentCharCount--;
+        Print (L"\b \b");
+        continue;
+      }
+
+      // If enter, break out.
+      if (KeyValue == L'\r') {
+        break;
+      }
+
+      // If not a number or separator, ignore.
+      if (!Backspace && ((KeyValue < L'0') || (KeyValue > '9')) && (KeyValue != L' ') && (KeyValue != L',')) {
+        continue;
+      }
+
+      // If no selection, we don't want to backspace.
+      // If we are at the max, don't accept any more.
+      if (((CurrentCharCount == 0) && Backspace) || (CurrentCharCount >= MAX_LIST_CHARS)) {
+        continue;
+      }
+
+      // Get character.
+      CurrentBuffer[CurrentCharCount] = KeyValue;
+      Print (L"%c", CurrentBuffer[CurrentCharCount]);
+      CurrentCharCount++;
+    }
+    Print (L"\n");
+  }
+  CurrentBuffer[CurrentCharCount] = CHAR_NULL;
+
+  Selected = AllocateZeroPool (mDevicesCount * sizeof (BOOLEAN));
+  if (Selected == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  // Parse device numbers.
+  Any     = FALSE;
+  Number  = 0;
+  for (i = 0; i <= CurrentCharCount; i++) {
+    if ((CurrentBuffer[i] >= L'0') && (CurrentBuffer[i] <= L'9')) {
+      Number = Number * 10 + (CurrentBuffer[i] - L'0');
+      continue;
+    }
+
+    if ((Number > 0) && (Number <= mDevicesCount)) {
+      Selected[Number - 1]  = TRUE;
+      Any                   = TRUE;
+    }
+    Number = 0;
+  }
+
+  if (!Any) {
+    SetMem (Selected, mDevicesCount * sizeof (BOOLEAN), TRUE);
+  }
+
+  Status = PlayParallel (Selected);
+  FreePool (Selected);
+
+  return Status;
+}
+
+// Test signal names and default frequencies, start frequency for sweeps.
+STATIC CONST struct {
+  CHAR16    *Name;
+  UINT32    ToneHz;
+} mSignals[ToneSignalMax] = {
+  { NULL,             0    },
+  { L"sine",          1000 },
+  { L"sweep",         20   },
+  { L"pink noise",    1000 },
+  { L"channel id",    500  },
+  { L"impulse",       1000 }
+};
+
+/**
+  Play a generated test signal on the current output. Samples are
+  synthesized in the output format as the stream needs them.
+**/
+STATIC
+EFI_STATUS
+TestSignal (
+  IN  UINTN   Signal,
+  IN  UINT32  ToneHz
+  )
+{
+  EFI_STATUS                  Status;
+  EFI_AUDIO_IO_PROTOCOL       *AudioIo;
+  EFI_AUDIO_IO_PROTOCOL_FREQ  Freq;
+  EFI_AUDIO_IO_PROTOCOL_BITS  Bits;
+  TONE_SOURCE                 Tone;
+  GAIN_SOURCE                 Gain;
+  AUDIO_SOURCE                *Source;
+  UINT8                       Volume;
+
+  //
+
+  if (mCurrentDevice == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if ((Signal == 0) || (Signal >= ToneSignalMax)) {
+    Print (L"Invalid signal.\n");
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (ToneHz == 0) {
+    ToneHz = mSignals[Signal].ToneHz;
+  }
+
+  AudioIo = mCurrentDevice->AudioIo;
+
+  Status = PickToneFormat (&mCurrentDevice->OutputPort, &Freq, &Bits);
+  if (EFI_ERROR (Status)) {
+    Print (L"No supported format on this output.\n");
+    return Status;
+  }
+
+  Status = ToneSourceInit (&Tone, Freq, Bits, AUDIO_OUTPUT_MAX_CHANNELS, (TONE_SIGNAL)Signal, ToneHz, SIGNAL_TEST_LENGTH);
+  if (EFI_ERROR (Status)) {
+    Print (L"Signal frequency %u Hz is not possible at %u Hz.\n", ToneHz, AudioIoFreqToHz (Freq));
+    return Status;
+  }
 
-  //
+  Source = &Tone.Source;
+  Volume = mDeviceVolume;
+  if (mSoftwareVolume) {
+    GainSourceInit (&Gain, Source, GainFromVolume (mDeviceVolume));
+    Source = &Gain.Source;
+    Volume = EFI_AUDIO_IO_PROTOCOL_MAX_VOLUME;
+  }
 
-  Print (L"Volume: (%d)\n", mDeviceVolume);
-  Print (L"Total devices: (%d)\n", mDevicesCount);
-  Print (L"Sampler: size (%d) freq (%d) bits (%d) chan (%d)\n", mBufferSize, mFrequency, mBits, mChannels);
+  Print (L"Playing %s at %u Hz, %u Hz %u-bit...\n", mSignals[Signal].Name, ToneHz, AudioIoFreqToHz (Freq), AudioIoBitsToWidth (Bits));
 
-  Status = PrintCurrentDevice ();
+  Status = AudioIo->SetupPlayback (AudioIo, (UINT8)mCurrentDevice->OutputPortIndex, Volume, Freq, Bits, AUDIO_OUTPUT_MAX_CHANNELS);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if (mSimpleTextIn != NULL) {
+    Print (L"Press Esc to stop.\n");
+  }
+
+  Status = PlaySampler (AudioIo, Source);
+  if (Status == EFI_ABORTED) {
+    return EFI_SUCCESS;
+  }
 
   return Status;
 }
 
+/**
+  Prompt for a test signal and an optional frequency, and play it.
+**/
 STATIC
 EFI_STATUS
-SelectDevice (
+SelectSignal (
   VOID
   )
 {
@@ -489,22 +2550,23 @@ SelectDevice (
   BOOLEAN       Backspace;
   CHAR16        CurrentBuffer[MAX_CHARS + 1];
   UINTN         CurrentCharCount;
-  UINTN         DeviceIndex;
+  UINTN         Numbers[2];
+  UINTN         NumberCount;
+  UINTN         i;
 
   //
 
-  // Check that parameters are valid.
-  if ((mSimpleTextIn == NULL) || (mDevices == NULL)) {
+  if ((mSimpleTextIn == NULL) || (mCurrentDevice == NULL)) {
     return EFI_INVALID_PARAMETER;
   }
 
-  // We need a null terminator.
-  CurrentBuffer[MAX_CHARS] = 0;
+  for (i = 1; i < ToneSignalMax; i++) {
+    Print (L"%u - %s\n", i, mSignals[i].Name);
+  }
 
-  // Prompt for device number.
   CurrentCharCount = 0;
 
-  Print (L"Enter the device number (0-%lu): ", mDevicesCount);
+  Print (L"Enter the signal, optionally followed by its frequency: ");
 
   while (TRUE) {
     // Wait for key.
@@ -527,8 +2589,8 @@ SelectDevice (
       break;
     }
 
-    // If not a number, ignore.
-    if (!Backspace && ((KeyValue < L'0') || (KeyValue > '9'))) {
+    // If not a number or separator, ignore.
+    if (!Backspace && ((KeyValue < L'0') || (KeyValue > '9')) && (KeyValue != L' ')) {
       continue;
     }
 
@@ -544,168 +2606,265 @@ SelectDevice (
     CurrentCharCount++;
   }
   Print (L"\n");
+  CurrentBuffer[CurrentCharCount] = CHAR_NULL;
+
+  // Parse signal and frequency.
+  Numbers[0]  = 0;
+  Numbers[1]  = 0;
+  NumberCount = 0;
+  for (i = 0; (i <= CurrentCharCount) && (NumberCount < ARRAY_SIZE (Numbers)); i++) {
+    if ((CurrentBuffer[i] >= L'0') && (CurrentBuffer[i] <= L'9')) {
+      Numbers[NumberCount] = Numbers[NumberCount] * 10 + (CurrentBuffer[i] - L'0');
+    } else if ((i > 0) && (CurrentBuffer[i - 1] != L' ')) {
+      NumberCount++;
+    }
+  }
 
-  // Clear out extra characters.
-  SetMem (CurrentBuffer + CurrentCharCount, MAX_CHARS - CurrentCharCount, 0);
+  return TestSignal (Numbers[0], (UINT32)Numbers[1]);
+}
 
-  // Get device index.
-  DeviceIndex = StrDecimalToUintn (CurrentBuffer);
-  if (DeviceIndex == 0) {
-    DeviceIndex = 1;
+//
+// Script commands, matching the menu entries.
+//
+STATIC CONST struct {
+  CHAR16    *Name;
+  CHAR16    Command;
+  BOOLEAN   HasArgument;
+} mScriptCommands[] = {
+  { L"list",    BCFG_ARG_LIST,    FALSE },
+  { L"current", BCFG_ARG_CURR,    FALSE },
+  { L"dump",    BCFG_ARG_DUMP,    FALSE },
+  { L"select",  BCFG_ARG_SELECT,  TRUE  },
+  { L"volume",  BCFG_ARG_VOLUME,  TRUE  },
+  { L"gain",    BCFG_ARG_GAIN,    TRUE  },
+  { L"test",    BCFG_ARG_TEST,    FALSE },
+  { L"sweep",   BCFG_ARG_SWEEP,   FALSE },
+  { L"all",     BCFG_ARG_ALL,     FALSE },
+  { L"signal",  BCFG_ARG_SIGNAL,  TRUE  },
+  { L"profile", BCFG_ARG_PERF,    FALSE },
+  { L"quit",    BCFG_ARG_QUIT,    FALSE }
+};
+
+/**
+  Split off the next space separated token, lowercased in place.
+  Returns NULL when there are no more tokens.
+**/
+STATIC
+CHAR16 *
+GetScriptToken (
+  IN OUT CHAR16   **Cursor
+  )
+{
+  CHAR16    *Token;
+  CHAR16    *Char;
+
+  //
+
+  Token = *Cursor;
+  while ((*Token == L' ') || (*Token == L'\t')) {
+    Token++;
   }
-  DeviceIndex -= 1;
 
-  // Ensure index is in range.
-  if (DeviceIndex >= mDevicesCount) {
-    Print (L"The selected device is not valid.\n");
-    return EFI_SUCCESS;
+  if (*Token == CHAR_NULL) {
+    *Cursor = Token;
+    return NULL;
   }
 
-  mCurrentDevice = &mDevices[DeviceIndex];
+  for (Char = Token; (*Char != CHAR_NULL) && (*Char != L' ') && (*Char != L'\t'); Char++) {
+    if ((*Char >= L'A') && (*Char <= L'Z')) {
+      *Char += 32;
+    }
+  }
 
-  Status = PrintCurrentDevice ();
+  if (*Char != CHAR_NULL) {
+    *Char++ = CHAR_NULL;
+  }
+  *Cursor = Char;
 
-  return Status;
+  return Token;
 }
 
-EFI_STATUS
-EFIAPI
-SelectVolume (
-  VOID
+STATIC
+INTN
+FindScriptCommand (
+  IN  CONST CHAR16  *Token
   )
 {
-  EFI_STATUS    Status;
-  CHAR16        KeyValue;
-  BOOLEAN       Backspace;
-  CHAR16        CurrentBuffer[MAX_CHARS + 1];
-  UINTN         CurrentCharCount;
-  UINTN         Volume;
+  UINTN   i;
 
   //
 
-  // Check that parameters are valid.
-  if (mSimpleTextIn == NULL) {
-    return EFI_INVALID_PARAMETER;
+  for (i = 0; i < ARRAY_SIZE (mScriptCommands); i++) {
+    if (StrCmp (Token, mScriptCommands[i].Name) == 0) {
+      return (INTN)i;
+    }
   }
 
-  // We need a null terminator.
-  CurrentBuffer[MAX_CHARS] = 0;
-
-  // Prompt for device number.
-  CurrentCharCount = 0;
+  return -1;
+}
 
-  Print (L"Enter the desired volume (0-100): ");
+/**
+  Get script from the image load options, if there is any.
 
-  while (TRUE) {
-    // Wait for key.
-    Status = WaitForKey (&KeyValue);
-    if (EFI_ERROR (Status)) {
-      return Status;
-    }
+  The shell passes the whole command line, so a leading token that is not a
+  command (the image name) is skipped. Options that are not a terminated
+  string, e.g. binary boot option data, are ignored.
+**/
+STATIC
+CHAR16 *
+GetScript (
+  IN  EFI_HANDLE  ImageHandle
+  )
+{
+  EFI_STATUS                  Status;
+  EFI_LOADED_IMAGE_PROTOCOL   *LoadedImage;
+  CHAR16                      *Script;
+  CHAR16                      *Cursor;
+  CHAR16                      *Token;
+  UINTN                       Length;
+  UINTN                       i;
 
-    Backspace = (KeyValue == L'\b');
+  //
 
-    // If we are backspacing, clear selection.
-    if ((CurrentCharCount != 0) && Backspace) {
-      CurrentCharCount--;
-      Print (L"\b \b");
-      continue;
-    }
+  Status = gBS->HandleProtocol (ImageHandle, &gEfiLoadedImageProtocolGuid, (VOID **)&LoadedImage);
+  if (EFI_ERROR (Status) || (LoadedImage->LoadOptions == NULL) || (LoadedImage->LoadOptionsSize < sizeof (CHAR16))) {
+    return NULL;
+  }
 
-    // If enter, break out.
-    if (KeyValue == L'\r') {
+  Length = LoadedImage->LoadOptionsSize / sizeof (CHAR16);
+  for (i = 0; i < Length; i++) {
+    if (((CHAR16 *)LoadedImage->LoadOptions)[i] == CHAR_NULL) {
       break;
     }
+  }
+  if (i == Length) {
+    return NULL;
+  }
 
-    // If not a number, ignore.
-    if (!Backspace && ((KeyValue < L'0') || (KeyValue > '9'))) {
-      continue;
-    }
-
-    // If no selection, we don't want to backspace.
-    // If we are at the max, don't accept any more.
-    if (((CurrentCharCount == 0) && Backspace) || (CurrentCharCount >= MAX_CHARS)) {
-      continue;
-    }
-
-    // Get character.
-    CurrentBuffer[CurrentCharCount] = KeyValue;
-    Print (L"%c", CurrentBuffer[CurrentCharCount]);
-    CurrentCharCount++;
+  Script = AllocateCopyPool ((i + 1) * sizeof (CHAR16), LoadedImage->LoadOptions);
+  if (Script == NULL) {
+    return NULL;
   }
-  Print (L"\n");
 
-  // Clear out extra characters.
-  SetMem (CurrentBuffer + CurrentCharCount, MAX_CHARS - CurrentCharCount, 0);
+  // Skip image name.
+  Cursor  = Script;
+  Token   = GetScriptToken (&Cursor);
+  if ((Token != NULL) && (FindScriptCommand (Token) < 0)) {
+    Token = GetScriptToken (&Cursor);
+  }
 
-  // Get device index.
-  Volume = StrDecimalToUintn (CurrentBuffer);
-  if (Volume > EFI_AUDIO_IO_PROTOCOL_MAX_VOLUME) {
-    Volume = EFI_AUDIO_IO_PROTOCOL_MAX_VOLUME;
+  if (Token == NULL) {
+    FreePool (Script);
+    return NULL;
   }
-  mDeviceVolume = (UINT8)Volume;
 
-  // Success.
-  Print (L"Volume set to %u\n", mDeviceVolume);
+  // Move remaining script to the start, first token is terminated already.
+  Length = StrLen (Token);
+  if (*Cursor != CHAR_NULL) {
+    Token[Length] = L' ';
+  }
+  CopyMem (Script, Token, StrSize (Token));
 
-  return EFI_SUCCESS;
+  return Script;
 }
 
+/**
+  Run a script of menu commands without console input, e.g.
+  "select 2 volume 80 test quit".
+
+  Stops at the first failing command, whose status is returned.
+**/
 STATIC
 EFI_STATUS
-TestOutput (
-  VOID
+RunScript (
+  IN  CHAR16  *Script
   )
 {
-  EFI_STATUS              Status;
-  EFI_AUDIO_IO_PROTOCOL   *AudioIo;
-  UINTN                   OutputIndex;
+  EFI_STATUS    Status;
+  CHAR16        *Cursor;
+  CHAR16        *Token;
+  CHAR16        *Argument;
+  INTN          Index;
 
   //
 
-  if (mCurrentDevice == NULL) {
-    return EFI_INVALID_PARAMETER;
-  }
+  Status  = EFI_SUCCESS;
+  Cursor  = Script;
 
-  AudioIo     = mCurrentDevice->AudioIo;
-  OutputIndex = mCurrentDevice->OutputPortIndex;
+  while ((Token = GetScriptToken (&Cursor)) != NULL) {
+    Index = FindScriptCommand (Token);
+    if (Index < 0) {
+      Print (L"Unknown command: %s\n", Token);
+      return EFI_INVALID_PARAMETER;
+    }
 
-  // Setup playback.
-  Print (L"Playing back audio...\n");
+    Argument = NULL;
+    if (mScriptCommands[Index].HasArgument) {
+      Argument = GetScriptToken (&Cursor);
+      if ((Argument == NULL) || (*Argument < L'0') || (*Argument > L'9')) {
+        Print (L"Command %s needs a number.\n", Token);
+        return EFI_INVALID_PARAMETER;
+      }
+      Print (L"> %s %s\n", Token, Argument);
+    } else {
+      Print (L"> %s\n", Token);
+    }
 
-  Status = AudioIo->SetupPlayback (AudioIo, (UINT8)OutputIndex, mDeviceVolume, mFrequency, mBits, mChannels);
-  if (EFI_ERROR (Status)) {
-    return Status;
-  }
+    switch (mScriptCommands[Index].Command) {
+      case BCFG_ARG_LIST:
+        Status = PrintDevices ();
+        break;
 
-  // Play chime.
-  return AudioIo->StartPlayback (AudioIo, mBuffer, mBufferSize, 0);
-}
+      case BCFG_ARG_CURR:
+        Status = PrintCurrentSetting ();
+        break;
 
-STATIC
-VOID
-DisplayMenu (
-  VOID
-  )
-{
-  // Clear screen.
-  if (gST->ConOut != NULL) {
-    gST->ConOut->ClearScreen (gST->ConOut);
+      case BCFG_ARG_DUMP:
+        Status = DumpDevices ();
+        break;
+
+      case BCFG_ARG_SELECT:
+        Status = SetCurrentDevice (StrDecimalToUintn (Argument));
+        break;
+
+      case BCFG_ARG_VOLUME:
+        Status = SetVolume (StrDecimalToUintn (Argument));
+        break;
+
+      case BCFG_ARG_GAIN:
+        Status = SetSoftwareVolume (StrDecimalToUintn (Argument) != 0);
+        break;
+
+      case BCFG_ARG_TEST:
+        Status = TestOutput ();
+        break;
+
+      case BCFG_ARG_SWEEP:
+        Status = SweepOutputs ();
+        break;
+
+      case BCFG_ARG_ALL:
+        Status = TestParallel ();
+        break;
+
+      case BCFG_ARG_SIGNAL:
+        Status = TestSignal (StrDecimalToUintn (Argument), 0);
+        break;
+
+      case BCFG_ARG_PERF:
+        Status = PrintTimings ();
+        break;
+
+      case BCFG_ARG_QUIT:
+        return EFI_SUCCESS;
+    }
+
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
   }
 
-  // Print menu.
-  Print (L"\n");
-  Print (L"Configures the AudioDxe EFI driver.\n");
-  Print (L"=========================================\n");
-  Print (L"%c - List all audio outputs\n", BCFG_ARG_LIST);
-  Print (L"%c - Dump audio outputs to file\n", BCFG_ARG_DUMP);
-  Print (L"%c - Select audio output\n", BCFG_ARG_SELECT);
-  Print (L"%c - Show current setting\n", BCFG_ARG_CURR);
-  Print (L"%c - Change volume\n", BCFG_ARG_VOLUME);
-  Print (L"%c - Test current audio output\n", BCFG_ARG_TEST);
-  Print (L"%c - Quit\n", BCFG_ARG_QUIT);
-  Print (L"\n");
-  Print (L"Enter an option: ");
+  return Status;
 }
 
 EFI_STATUS
@@ -719,16 +2878,35 @@ AudioDxeCfgMain (
   BOOLEAN       Backspace;
   CHAR16        KeyValue;
   CHAR16        Selection;
+  CHAR16        *Script;
+  UINT64        StartTicks;
+  UINT64        MenuStartTicks;
+  UINTN         DeviceIndex;
 
   //
 
-  // Ensure ConIn is valid.
-  if (gST->ConIn == NULL) {
-    Print (L"There is no console input device.\n");
-    Status = EFI_UNSUPPORTED;
+  StartTicks = GetPerformanceCounter ();
+
+  // Scripts run without console input.
+  Script = GetScript (ImageHandle);
+  if (Script == NULL) {
+    // Ensure ConIn is valid.
+    if (gST->ConIn == NULL) {
+      Print (L"There is no console input device.\n");
+      Status = EFI_UNSUPPORTED;
+      goto DONE;
+    }
+    mSimpleTextIn = gST->ConIn;
+  }
+
+  mTimings.ConInTicks = GetPerformanceCounter () - StartTicks;
+
+#ifdef AUDIODXECFG_MOCK_AUDIO_IO
+  Status = MockAudioIoInstall (MOCK_AUDIO_IO_CODECS, MOCK_AUDIO_IO_PORTS);
+  if (EFI_ERROR (Status)) {
     goto DONE;
   }
-  mSimpleTextIn = gST->ConIn;
+#endif
 
   // Get devices.
   Status = GetOutputDevices ();
@@ -736,19 +2914,28 @@ AudioDxeCfgMain (
     goto DONE;
   }
 
-  // Get decoder, decoding sampler.
-  Status = GetAudioDecoder ();
-  if (EFI_ERROR (Status)) {
+  // Restore settings stored by earlier sessions.
+  if (!EFI_ERROR (SettingsLoad (mDevices, mDevicesCount, &DeviceIndex, &mDeviceVolume, &mSoftwareVolume))) {
+    mCurrentDevice = &mDevices[DeviceIndex];
+  }
+
+  if (Script != NULL) {
+    Status = RunScript (Script);
     goto DONE;
   }
 
+  // Drop keys pressed before startup. Later ones are kept as type-ahead.
+  FlushKeystrokes ();
+
   // Command loop.
+  MenuStartTicks = GetPerformanceCounter ();
   while (TRUE) {
     // Show menu.
     DisplayMenu ();
 
-    // Flush any keystrokes.
-    FlushKeystrokes ();
+    // Round trip from the last keystroke until ready for a selection.
+    mTimings.MenuTicks += GetPerformanceCounter () - MenuStartTicks;
+    mTimings.MenuCount++;
 
     // Handle keyboard input.
     Selection = CHAR_NULL;
@@ -795,9 +2982,6 @@ AudioDxeCfgMain (
     }
     Print (L"\n\n");
 
-    // Flush any keystrokes.
-    FlushKeystrokes ();
-
     // Execute command.
     switch (Selection) {
       // List devices.
@@ -840,6 +3024,14 @@ AudioDxeCfgMain (
         }
         break;
 
+      // Toggle software volume.
+      case BCFG_ARG_GAIN:
+        Status = SetSoftwareVolume (!mSoftwareVolume);
+        if (EFI_ERROR (Status)) {
+          goto DONE;
+        }
+        break;
+
       // Test playback.
       case BCFG_ARG_TEST:
         Status = TestOutput ();
@@ -848,6 +3040,38 @@ AudioDxeCfgMain (
         }
         break;
 
+      // Test all outputs.
+      case BCFG_ARG_SWEEP:
+        Status = SweepOutputs ();
+        if (EFI_ERROR (Status) && (Status != EFI_DEVICE_ERROR)) {
+          goto DONE;
+        }
+        break;
+
+      // Test outputs at once.
+      case BCFG_ARG_ALL:
+        Status = TestParallel ();
+        if (EFI_ERROR (Status) && (Status != EFI_DEVICE_ERROR)) {
+          goto DONE;
+        }
+        break;
+
+      // Play test signal.
+      case BCFG_ARG_SIGNAL:
+        Status = SelectSignal ();
+        if (EFI_ERROR (Status) && (Status != EFI_INVALID_PARAMETER) && (Status != EFI_UNSUPPORTED)) {
+          goto DONE;
+        }
+        break;
+
+      // Show timings.
+      case BCFG_ARG_PERF:
+        Status = PrintTimings ();
+        if (EFI_ERROR (Status)) {
+          goto DONE;
+        }
+        break;
+
       // Quit.
       case BCFG_ARG_QUIT:
         Status = EFI_SUCCESS;
@@ -863,19 +3087,57 @@ AudioDxeCfgMain (
 
     WaitForKey (&KeyValue);
 
-    FlushKeystrokes ();
+    MenuStartTicks = GetPerformanceCounter ();
   }
 
   DONE:
 
-  if (mDevices != NULL) {
-    FreePool (mDevices);
+  if (Script != NULL) {
+    FreePool (Script);
   }
 
-  if (mBuffer != NULL) {
+  FreeOutputDevices ();
+
+  if (mTimings.HandleTicks != NULL) {
+    FreePool (mTimings.HandleTicks);
+  }
+
+  if (mTimings.HandleOutputs != NULL) {
+    FreePool (mTimings.HandleOutputs);
+  }
+
+  if (mSweepResults != NULL) {
+    FreePool (mSweepResults);
+  }
+
+  if (mBufferAllocated) {
     FreePool (mBuffer);
   }
 
+  if (mConvertedBuffer != NULL) {
+    FreePool (mConvertedBuffer);
+  }
+
+  ConvertSourceFree (&mConvertSource);
+  ResampleSourceFree (&mResampleSource);
+
+  if (mScaledBuffer != NULL) {
+    FreePool (mScaledBuffer);
+  }
+
+  Mp3StreamClose (&mMp3Stream);
+  FileSourceClose (&mFileSource);
+  SettingsFree ();
+
+  if (mSamplerDataAllocated) {
+    FreePool ((VOID *)mSamplerData);
+  }
+
+#ifdef AUDIODXECFG_MOCK_AUDIO_IO
+  MockAudioIoPrintStats ();
+  MockAudioIoUninstall ();
+#endif
+
   // Show error.
   if (EFI_ERROR (Status)) {
     if (Status == EFI_NOT_FOUND) {
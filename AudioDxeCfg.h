@@ -34,10 +34,12 @@
 //#include <Library/BootChimeLib.h>
 #include <Library/OcAudioLib.h>
 #include <Library/OcDevicePathLib.h>
+#include <Library/OcFileLib.h>
 #include <Library/OcStringLib.h>
 #include <Library/DebugLib.h>
 #include <Library/DevicePathLib.h>
 #include <Library/MemoryAllocationLib.h>
+#include <Library/TimerLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiRuntimeServicesTableLib.h>
 #include <Library/UefiLib.h>
@@ -55,20 +57,662 @@
 #define BCFG_ARG_SELECT L'S'
 #define BCFG_ARG_VOLUME L'V'
 #define BCFG_ARG_TEST   L'T'
+#define BCFG_ARG_PERF   L'P'
+#define BCFG_ARG_SWEEP  L'W'
+#define BCFG_ARG_ALL    L'A'
+#define BCFG_ARG_GAIN   L'G'
+#define BCFG_ARG_SIGNAL L'N'
 #define BCFG_ARG_QUIT   L'Q'
 
 #define MAX_CHARS       (12)
+#define MAX_LIST_CHARS  (64)
+
+// Sweep test clip length in milliseconds, and its report file.
+#define SWEEP_CLIP_LENGTH         (1500)
+#define SWEEP_FILE_NAME           L"AudioDxeCfgSweep.txt"
+#define SWEEP_REPORT_LINE_SIZE    (160)
+
+// Channels played at most, wider samplers are mixed down.
+#define AUDIO_OUTPUT_MAX_CHANNELS (2)
+
+// Resampler prototype filter, one side, and processing limits.
+#define RESAMPLE_ZERO_CROSSINGS     (32)
+#define RESAMPLE_FILTER_RESOLUTION  (128)
+#define RESAMPLE_FILTER_LENGTH      (RESAMPLE_ZERO_CROSSINGS * RESAMPLE_FILTER_RESOLUTION + 1)
+#define RESAMPLE_MAX_TAPS           (512)
+#define RESAMPLE_COEF_SHIFT         (30)
+#define RESAMPLE_COEF_ONE           (1 << RESAMPLE_COEF_SHIFT)
+#define RESAMPLE_BLOCK_FRAMES       (1024)
+
+// Software gain of 0 dB, in 16.16 fixed point.
+#define GAIN_UNITY                (0x10000)
+
+// Parallel test tone length in milliseconds, lowest tone, and tone amplitude (-6 dBFS).
+#define PARALLEL_TONE_LENGTH      (3000)
+#define PARALLEL_TONE_BASE_HZ     (262)
+#define TONE_AMPLITUDE            (16384)
+
+// Test signal length in milliseconds, and generator parameters: channel and
+// impulse segments in milliseconds, sweep end, pink noise rows, edge ramps.
+#define SIGNAL_TEST_LENGTH        (5000)
+#define TONE_SEGMENT_LENGTH       (1000)
+#define TONE_SWEEP_END            (20000)
+#define TONE_PINK_ROWS            (12)
+#define TONE_NOISE_SEED           (0x2545F491)
+#define TONE_RAMP_SAMPLES         (256)
+
+// Keys kept as type-ahead.
+#define KEY_QUEUE_SIZE            (64)
+
+// Timing report file written next to the audio dump.
+#define TIMINGS_FILE_NAME         L"AudioDxeCfgTimings.txt"
+#define TIMINGS_REPORT_SIZE       (1024)
+#define TIMINGS_REPORT_LINE_SIZE  (64)
+
+// Structured output dump written along with the text one, format version and sizing.
+#define DEVICES_JSON_FILE_NAME    L"AudioDxeCfgDevices.json"
+#define DEVICES_JSON_VERSION      (1)
+#define DEVICES_JSON_HEADER_SIZE  (256)
+#define DEVICES_JSON_OUTPUT_SIZE  (512)
+
+//
+// Chime files next to the application replace the embedded sampler. Files
+// are probed for a PCM WAV header, which are streamed, others are loaded
+// whole up to a limit. Streamed reads end on common cluster boundaries.
+//
+#define CHIME_FILE_PROBE_SIZE     (SIZE_64KB)
+#define CHIME_FILE_MAX_SIZE       (SIZE_16MB)
+#define FILE_SOURCE_ALIGNMENT     (SIZE_4KB)
+
+// Output enumeration cache written next to the application, and its size limit.
+#define DEVICE_CACHE_FILE_NAME    L"AudioDxeCfgCache.bin"
+#define DEVICE_CACHE_MAX_SIZE     (SIZE_64KB)
+
+//
+// Selected output and volume, kept in one non-volatile variable so boot chime
+// drivers can read the same record. The record is followed by the device
+// path of the output's Audio I/O handle, up to the end of the variable.
+//
+#define AUDIO_SETTINGS_VARIABLE_NAME    L"AudioDxeCfgSettings"
+#define AUDIO_SETTINGS_VARIABLE_GUID    { 0x2450E014, 0x40A6, 0x495A, { 0x95, 0x3F, 0x4B, 0x16, 0x5F, 0x9A, 0xD1, 0xDD } }
+#define AUDIO_SETTINGS_SIGNATURE        SIGNATURE_32 ('A', 'D', 'C', 'S')
+#define AUDIO_SETTINGS_VERSION          (1)
+#define AUDIO_SETTINGS_MAX_SIZE         (SIZE_1KB)
+#define AUDIO_SETTINGS_SOFTWARE_VOLUME  BIT0
+
+typedef struct {
+  UINT32    Signature;
+  UINT8     Version;
+  UINT8     Volume;
+  UINT8     Flags;
+  UINT8     OutputPortIndex;
+} AUDIO_SETTINGS_RECORD;
+
+// Playback progress refresh interval, in 100 ns units.
+#define PROGRESS_INTERVAL   (2000000)
+
+// Streaming playback buffers.
+#define AUDIO_STREAM_BUFFER_COUNT   (3)
+#define AUDIO_STREAM_BUFFER_SIZE    (SIZE_64KB)
+
+// Fade at playback start, end and cancel in milliseconds, and envelope table steps.
+#define AUDIO_STREAM_FADE_LENGTH    (5)
+#define FADE_STEPS                  (64)
+
+// MP3 frames decoded per streamed chunk, and preceding frames decoded to prime it.
+#define MP3_STREAM_CHUNK_FRAMES     (32)
+#define MP3_STREAM_PRIMING_FRAMES   (2)
 
 // Boot chime output device.
+//
+// Root path and its text are shared by all outputs of a handle, and owned by
+// the output at port index 0.
+//
 typedef struct {
   EFI_AUDIO_IO_PROTOCOL       *AudioIo;
   EFI_DEVICE_PATH_PROTOCOL    *DevicePath;
+  EFI_DEVICE_PATH_PROTOCOL    *RootDevicePath;
+  CHAR16                      *DevicePathText;
   EFI_AUDIO_IO_PROTOCOL_PORT  OutputPort;
   UINTN                       OutputPortIndex;
 } AUDIO_DEVICE;
 
+// Outputs reported by one Audio I/O handle, kept between enumeration passes.
+typedef struct {
+  EFI_AUDIO_IO_PROTOCOL       *AudioIo;
+  EFI_DEVICE_PATH_PROTOCOL    *DevicePath;
+  EFI_DEVICE_PATH_PROTOCOL    *RootDevicePath;
+  CHAR16                      *DevicePathText;
+  EFI_AUDIO_IO_PROTOCOL_PORT  *OutputPorts;
+  UINTN                       OutputPortsCount;
+} AUDIO_IO_OUTPUTS;
+
+// Startup phase timings, in performance counter ticks.
+typedef struct {
+  UINT64                      ConInTicks;
+  UINT64                      EnumerationTicks;
+  BOOLEAN                     EnumerationCached;
+  UINTN                       HandleCount;
+  UINT64                      *HandleTicks;
+  UINTN                       *HandleOutputs;
+  UINT64                      DecodeTicks;
+  UINT64                      MenuTicks;
+  UINTN                       MenuCount;
+  UINT64                      FlushTicks;
+  UINTN                       FlushCount;
+} AUDIO_TIMINGS;
+
+// Sweep test result of one output.
+typedef struct {
+  EFI_STATUS                  Status;
+  UINT64                      SetupTicks;
+  UINT64                      PlayTicks;
+} SWEEP_RESULT;
+
+// PCM sample source.
+typedef struct _AUDIO_SOURCE AUDIO_SOURCE;
+
+/**
+  Read PCM from the source.
+
+  @param[in]  This          Audio source.
+  @param[out] Buffer        Destination buffer.
+  @param[in]  Length        Size of Buffer in bytes.
+  @param[out] ReadLength    Bytes written to Buffer.
+
+  @retval EFI_END_OF_FILE when the source is exhausted.
+**/
+typedef
+EFI_STATUS
+(EFIAPI *AUDIO_SOURCE_READ)(
+  IN  AUDIO_SOURCE  *This,
+  OUT UINT8         *Buffer,
+  IN  UINTN         Length,
+  OUT UINTN         *ReadLength
+  );
+
+typedef
+EFI_STATUS
+(EFIAPI *AUDIO_SOURCE_REWIND)(
+  IN  AUDIO_SOURCE  *This
+  );
+
+struct _AUDIO_SOURCE {
+  AUDIO_SOURCE_READ           Read;
+  AUDIO_SOURCE_REWIND         Rewind;
+  EFI_AUDIO_IO_PROTOCOL_FREQ  Frequency;
+  EFI_AUDIO_IO_PROTOCOL_BITS  Bits;
+  UINT8                       Channels;
+  UINTN                       TotalSamples;
+};
+
+// Source reading PCM from memory.
+typedef struct {
+  AUDIO_SOURCE                Source;
+  CONST UINT8                 *Data;
+  UINTN                       Length;
+  UINTN                       Position;
+} MEMORY_SOURCE;
+
+// Source playing at most a given number of samples of another one.
+typedef struct {
+  AUDIO_SOURCE                Source;
+  AUDIO_SOURCE                *Inner;
+  UINTN                       Length;
+  UINTN                       Position;
+} LIMITED_SOURCE;
+
+// Chunked MP3 decoding state.
+typedef struct {
+  AUDIO_SOURCE                Source;
+  EFI_AUDIO_DECODE_PROTOCOL   *AudioDecode;
+  CONST UINT8                 *Data;
+  UINTN                       DataLength;
+  UINTN                       DataOffset;
+  UINT32                      *FrameOffsets;
+  UINTN                       FrameCount;
+  UINTN                       NextFrame;
+  UINT32                      SamplesPerFrame;
+  UINT8                       *Chunk;
+  UINT32                      ChunkSize;
+  UINT32                      ChunkPosition;
+  UINTN                       ChunkFrame;
+  UINT64                      DecodeTicks;
+  UINTN                       DecodedFrames;
+  EFI_AUDIO_IO_PROTOCOL_FREQ  Frequency;
+  EFI_AUDIO_IO_PROTOCOL_BITS  Bits;
+  UINT8                       Channels;
+} MP3_STREAM;
+
+// Channels held by ADPCM compressed samplers at most.
+#define ADPCM_MAX_CHANNELS          (2)
+
+// IMA ADPCM compressed sampler decoding state.
+typedef struct {
+  AUDIO_SOURCE                Source;
+  CONST UINT8                 *Data;
+  CONST UINT8                 *DataEnd;
+  UINTN                       BlockFrames;
+  CONST UINT8                 *Block;
+  CONST UINT8                 *Codes;
+  UINTN                       Nibble;
+  UINTN                       FrameInBlock;
+  UINTN                       Position;
+  INT32                       Predictor[ADPCM_MAX_CHANNELS];
+  UINT8                       StepIndex[ADPCM_MAX_CHANNELS];
+  UINT64                      DecodeTicks;
+  UINTN                       DecodedFrames;
+} ADPCM_SOURCE;
+
+// PCM WAV sampler read from a file as it is played.
+typedef struct {
+  AUDIO_SOURCE                Source;
+  EFI_FILE_PROTOCOL           *File;
+  UINT64                      DataOffset;
+  UINT64                      DataLength;
+  UINT64                      Position;
+  UINTN                       BlockAlign;
+  UINT64                      ReadTicks;
+  UINT64                      ReadBytes;
+  UINTN                       ReadCount;
+} FILE_SOURCE;
+
+// Streaming playback state, shared with the Audio I/O completion callback.
+typedef struct {
+  EFI_AUDIO_IO_PROTOCOL       *AudioIo;
+  AUDIO_SOURCE                *Source;
+  UINT8                       *Buffers[AUDIO_STREAM_BUFFER_COUNT];
+  UINTN                       BufferLengths[AUDIO_STREAM_BUFFER_COUNT];
+  UINTN                       BufferSize;
+  UINTN                       BlockAlign;
+  UINTN                       FillIndex;
+  volatile UINTN              PlayIndex;
+  volatile UINTN              FilledCount;
+  volatile BOOLEAN            Playing;
+  volatile BOOLEAN            Stopping;
+  BOOLEAN                     SourceDone;
+  UINTN                       ReadSamples;
+  UINTN                       HeldSamples;
+  UINTN                       FadeSamples;
+  volatile UINTN              SubmittedSamples;
+  volatile UINTN              PlayedSamples;
+  EFI_EVENT                   RefillEvent;
+} AUDIO_STREAM;
+
+// Source scaling samples of another one by a software gain.
+typedef struct {
+  AUDIO_SOURCE                Source;
+  AUDIO_SOURCE                *Inner;
+  UINT32                      Gain;
+} GAIN_SOURCE;
+
+// Source converting samples of another one to a different format.
+typedef struct {
+  AUDIO_SOURCE                Source;
+  AUDIO_SOURCE                *Inner;
+  UINT8                       *Scratch;
+  UINTN                       ScratchSize;
+} CONVERT_SOURCE;
+
+// Sample rate conversion state.
+typedef struct {
+  AUDIO_SOURCE                Source;
+  AUDIO_SOURCE                *Inner;
+  UINT32                      L;
+  UINT32                      M;
+  UINTN                       Taps;
+  INT32                       *Coefs;
+  INT32                       *Window;
+  UINTN                       WindowSize;
+  UINTN                       WindowCount;
+  UINTN                       Base;
+  UINT32                      Phase;
+  UINT64                      Center;
+  UINT64                      InputFrames;
+  BOOLEAN                     InnerDone;
+  BOOLEAN                     Flushed;
+  UINT8                       *Scratch;
+  UINT64                      Ticks;
+  UINT64                      Frames;
+} RESAMPLE_SOURCE;
+
+// Generated test signals.
+typedef enum {
+  ToneSignalSine = 1,
+  ToneSignalSweep,
+  ToneSignalPinkNoise,
+  ToneSignalChannelId,
+  ToneSignalImpulse,
+  ToneSignalMax
+} TONE_SIGNAL;
+
+// Test signal generator state.
+typedef struct {
+  AUDIO_SOURCE                Source;
+  TONE_SIGNAL                 Signal;
+  UINT32                      Phase;
+  UINT32                      PhaseStep;
+  UINT32                      BaseStep;
+  UINT64                      SweepStep;
+  UINT64                      SweepDelta;
+  INT32                       Amplitude;
+  UINTN                       Position;
+  UINTN                       SegmentLength;
+  UINT32                      Seed;
+  INT32                       Rows[TONE_PINK_ROWS];
+  INT32                       RowSum;
+} TONE_SOURCE;
+
+// Output playing in a parallel test.
+typedef struct {
+  UINTN                       DeviceIndex;
+  UINT32                      ToneHz;
+  TONE_SOURCE                 Tone;
+  GAIN_SOURCE                 Gain;
+  AUDIO_STREAM                Stream;
+  EFI_STATUS                  Status;
+} PARALLEL_OUTPUT;
+
+UINT8
+AudioIoBytesPerSample (
+  IN  EFI_AUDIO_IO_PROTOCOL_BITS  Bits
+  );
+
+VOID
+MemorySourceInit (
+  OUT MEMORY_SOURCE               *Source,
+  IN  CONST UINT8                 *Data,
+  IN  UINTN                       Length,
+  IN  EFI_AUDIO_IO_PROTOCOL_FREQ  Frequency,
+  IN  EFI_AUDIO_IO_PROTOCOL_BITS  Bits,
+  IN  UINT8                       Channels
+  );
+
+UINT8
+AudioIoBitsToWidth (
+  IN  EFI_AUDIO_IO_PROTOCOL_BITS  Bits
+  );
+
+/**
+  Read one sample as signed 32-bit, MSB aligned.
+**/
+INT32
+ConvertLoadSample (
+  IN  CONST UINT8                 *Sample,
+  IN  EFI_AUDIO_IO_PROTOCOL_BITS  Bits
+  );
+
+/**
+  Store one signed 32-bit MSB aligned sample, truncated to the target width.
+**/
+VOID
+ConvertStoreSample (
+  OUT UINT8                       *Sample,
+  IN  EFI_AUDIO_IO_PROTOCOL_BITS  Bits,
+  IN  INT32                       Value
+  );
+
+VOID
+ConvertSamples (
+  IN  CONST UINT8                 *In,
+  IN  EFI_AUDIO_IO_PROTOCOL_BITS  InBits,
+  IN  UINT8                       InChannels,
+  OUT UINT8                       *Out,
+  IN  EFI_AUDIO_IO_PROTOCOL_BITS  OutBits,
+  IN  UINT8                       OutChannels,
+  IN  UINTN                       Frames
+  );
+
+EFI_STATUS
+ConvertSourceInit (
+  OUT CONVERT_SOURCE              *Source,
+  IN  AUDIO_SOURCE                *Inner,
+  IN  EFI_AUDIO_IO_PROTOCOL_BITS  Bits,
+  IN  UINT8                       Channels
+  );
+
+VOID
+ConvertSourceFree (
+  IN  CONVERT_SOURCE  *Source
+  );
+
+EFI_STATUS
+ResampleSourceInit (
+  OUT RESAMPLE_SOURCE             *Source,
+  IN  AUDIO_SOURCE                *Inner,
+  IN  EFI_AUDIO_IO_PROTOCOL_FREQ  Frequency
+  );
+
+VOID
+ResampleSourceFree (
+  IN  RESAMPLE_SOURCE   *Source
+  );
+
+UINT32
+GainFromVolume (
+  IN  UINT8   Volume
+  );
+
+VOID
+GainApply (
+  IN OUT UINT8                       *Buffer,
+  IN     UINTN                       Length,
+  IN     EFI_AUDIO_IO_PROTOCOL_BITS  Bits,
+  IN     UINT32                      Gain
+  );
+
+VOID
+FadeApply (
+  IN OUT UINT8                       *Buffer,
+  IN     EFI_AUDIO_IO_PROTOCOL_BITS  Bits,
+  IN     UINT8                       Channels,
+  IN     UINTN                       Frames,
+  IN     UINTN                       Position,
+  IN     UINTN                       Length,
+  IN     BOOLEAN                     FadeOut
+  );
+
+VOID
+GainSourceInit (
+  OUT GAIN_SOURCE   *Source,
+  IN  AUDIO_SOURCE  *Inner,
+  IN  UINT32        Gain
+  );
+
+EFI_STATUS
+ToneSourceInit (
+  OUT TONE_SOURCE                 *Source,
+  IN  EFI_AUDIO_IO_PROTOCOL_FREQ  Frequency,
+  IN  EFI_AUDIO_IO_PROTOCOL_BITS  Bits,
+  IN  UINT8                       Channels,
+  IN  TONE_SIGNAL                 Signal,
+  IN  UINT32                      ToneHz,
+  IN  UINT32                      Length
+  );
+
+VOID
+LimitedSourceInit (
+  OUT LIMITED_SOURCE  *Source,
+  IN  AUDIO_SOURCE    *Inner,
+  IN  UINTN           MaxSamples
+  );
+
+EFI_STATUS
+AudioStreamCreate (
+  OUT AUDIO_STREAM            *Stream,
+  IN  EFI_AUDIO_IO_PROTOCOL   *AudioIo,
+  IN  AUDIO_SOURCE            *Source
+  );
+
+EFI_STATUS
+AudioStreamService (
+  IN  AUDIO_STREAM  *Stream
+  );
+
+BOOLEAN
+AudioStreamIsDone (
+  IN  AUDIO_STREAM  *Stream
+  );
+
+VOID
+AudioStreamStop (
+  IN  AUDIO_STREAM  *Stream
+  );
+
+VOID
+AudioStreamFadeOut (
+  IN  AUDIO_STREAM  *Stream
+  );
+
+VOID
+AudioStreamDestroy (
+  IN  AUDIO_STREAM  *Stream
+  );
+
+EFI_STATUS
+Mp3StreamOpen (
+  OUT MP3_STREAM                  *Stream,
+  IN  EFI_AUDIO_DECODE_PROTOCOL   *AudioDecode,
+  IN  CONST UINT8                 *Data,
+  IN  UINTN                       DataLength
+  );
+
+VOID
+Mp3StreamClose (
+  IN  MP3_STREAM    *Stream
+  );
+
+EFI_STATUS
+AdpcmSourceInit (
+  OUT ADPCM_SOURCE  *Source,
+  IN  CONST UINT8   *Data,
+  IN  UINTN         DataLength
+  );
+
+EFI_STATUS
+DeviceCacheLoad (
+  IN     EFI_FILE_PROTOCOL   *Dir,
+  IN OUT AUDIO_IO_OUTPUTS    *Outputs,
+  IN     UINTN               OutputsCount
+  );
+
+EFI_STATUS
+DeviceCacheSave (
+  IN  EFI_FILE_PROTOCOL   *Dir,
+  IN  AUDIO_IO_OUTPUTS    *Outputs,
+  IN  UINTN               OutputsCount
+  );
+
+EFI_STATUS
+SettingsLoad (
+  IN  AUDIO_DEVICE  *Devices,
+  IN  UINTN         DevicesCount,
+  OUT UINTN         *DeviceIndex,
+  OUT UINT8         *Volume,
+  OUT BOOLEAN       *SoftwareVolume
+  );
+
+EFI_STATUS
+SettingsSave (
+  IN  AUDIO_DEVICE  *Device,
+  IN  UINT8         Volume,
+  IN  BOOLEAN       SoftwareVolume
+  );
+
+VOID
+SettingsFree (
+  VOID
+  );
+
+EFI_STATUS
+FileSourceOpen (
+  OUT FILE_SOURCE         *Source,
+  IN  EFI_FILE_PROTOCOL   *File
+  );
+
+VOID
+FileSourceClose (
+  IN  FILE_SOURCE   *Source
+  );
+
+// WAVE format tags.
+#define WAVE_FORMAT_PCM         (0x0001)
+#define WAVE_FORMAT_EXTENSIBLE  (0xFFFE)
+
+// Parsed RIFF/WAVE header.
+typedef struct {
+  UINT16    FormatTag;
+  UINT16    Channels;
+  UINT32    SamplesPerSec;
+  UINT16    BlockAlign;
+  UINT16    BitsPerSample;
+  UINT32    DataOffset;
+  UINT32    DataLength;
+} WAVE_INFO;
+
+EFI_AUDIO_IO_PROTOCOL_FREQ
+AudioIoFreqFromHz (
+  IN  UINT32    Hz
+  );
+
+UINT32
+AudioIoFreqToHz (
+  IN  EFI_AUDIO_IO_PROTOCOL_FREQ  Frequency
+  );
+
+EFI_STATUS
+WaveParse (
+  IN  CONST UINT8   *Data,
+  IN  UINTN         DataLength,
+  OUT WAVE_INFO     *WaveInfo
+  );
+
+EFI_STATUS
+WaveGetAudioIoFormat (
+  IN  CONST WAVE_INFO               *WaveInfo,
+  OUT EFI_AUDIO_IO_PROTOCOL_FREQ    *Frequency,
+  OUT EFI_AUDIO_IO_PROTOCOL_BITS    *Bits
+  );
+
+#ifdef AUDIODXECFG_MOCK_AUDIO_IO
+
+// Mock codecs and output ports per codec installed for testing.
+#ifndef MOCK_AUDIO_IO_CODECS
+#define MOCK_AUDIO_IO_CODECS  (2)
+#endif
+
+#ifndef MOCK_AUDIO_IO_PORTS
+#define MOCK_AUDIO_IO_PORTS   (4)
+#endif
+
+EFI_STATUS
+MockAudioIoInstall (
+  IN  UINTN   CodecCount,
+  IN  UINTN   PortCount
+  );
+
+VOID
+MockAudioIoPrintStats (
+  VOID
+  );
+
+VOID
+MockAudioIoUninstall (
+  VOID
+  );
+
+#endif
+
 // Chime data.
 extern UINT8 mChimeData[];
 extern UINTN mChimeDataLength;
 
+// Chime data format when it is raw PCM in device format, zero when it needs decoding.
+extern EFI_AUDIO_IO_PROTOCOL_FREQ mChimeDataFreq;
+extern EFI_AUDIO_IO_PROTOCOL_BITS mChimeDataBits;
+extern UINT8 mChimeDataChannels;
+
+// Resampler prototype filter, see Tools/FilterGen.py.
+extern CONST INT32 mResampleFilter[RESAMPLE_FILTER_LENGTH];
+
 #endif
@@ -0,0 +1,560 @@
+/*
+ * File: AudioStream.c
+ *
+ * Description: Multi-buffered streaming playback.
+ *
+ * Copyright (c) 2018-2019 John Davis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "AudioDxeCfg.h"
+
+UINT8
+AudioIoBytesPerSample (
+  IN  EFI_AUDIO_IO_PROTOCOL_BITS  Bits
+  )
+{
+  switch (Bits) {
+    case EfiAudioIoBits8:
+      return 1;
+
+    case EfiAudioIoBits16:
+      return 2;
+
+    // Wider samples are stored in 32-bit containers.
+    default:
+      return 4;
+  }
+}
+
+UINT8
+AudioIoBitsToWidth (
+  IN  EFI_AUDIO_IO_PROTOCOL_BITS  Bits
+  )
+{
+  switch (Bits) {
+    case EfiAudioIoBits8:
+      return 8;
+
+    case EfiAudioIoBits16:
+      return 16;
+
+    case EfiAudioIoBits20:
+      return 20;
+
+    case EfiAudioIoBits24:
+      return 24;
+
+    default:
+      return 32;
+  }
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+MemorySourceRead (
+  IN  AUDIO_SOURCE  *This,
+  OUT UINT8         *Buffer,
+  IN  UINTN         Length,
+  OUT UINTN         *ReadLength
+  )
+{
+  MEMORY_SOURCE   *Source;
+
+  //
+
+  Source = BASE_CR (This, MEMORY_SOURCE, Source);
+
+  if (Source->Position >= Source->Length) {
+    *ReadLength = 0;
+    return EFI_END_OF_FILE;
+  }
+
+  *ReadLength = MIN (Length, Source->Length - Source->Position);
+  CopyMem (Buffer, &Source->Data[Source->Position], *ReadLength);
+  Source->Position += *ReadLength;
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+MemorySourceRewind (
+  IN  AUDIO_SOURCE  *This
+  )
+{
+  BASE_CR (This, MEMORY_SOURCE, Source)->Position = 0;
+
+  return EFI_SUCCESS;
+}
+
+VOID
+MemorySourceInit (
+  OUT MEMORY_SOURCE               *Source,
+  IN  CONST UINT8                 *Data,
+  IN  UINTN                       Length,
+  IN  EFI_AUDIO_IO_PROTOCOL_FREQ  Frequency,
+  IN  EFI_AUDIO_IO_PROTOCOL_BITS  Bits,
+  IN  UINT8                       Channels
+  )
+{
+  Source->Source.Read         = MemorySourceRead;
+  Source->Source.Rewind       = MemorySourceRewind;
+  Source->Source.Frequency    = Frequency;
+  Source->Source.Bits         = Bits;
+  Source->Source.Channels     = Channels;
+  Source->Source.TotalSamples = Length / (Channels * AudioIoBytesPerSample (Bits));
+  Source->Data                = Data;
+  Source->Length              = Length;
+  Source->Position            = 0;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+LimitedSourceRead (
+  IN  AUDIO_SOURCE  *This,
+  OUT UINT8         *Buffer,
+  IN  UINTN         Length,
+  OUT UINTN         *ReadLength
+  )
+{
+  EFI_STATUS      Status;
+  LIMITED_SOURCE  *Source;
+
+  //
+
+  Source = BASE_CR (This, LIMITED_SOURCE, Source);
+
+  if (Source->Position >= Source->Length) {
+    *ReadLength = 0;
+    return EFI_END_OF_FILE;
+  }
+
+  Status = Source->Inner->Read (Source->Inner, Buffer, MIN (Length, Source->Length - Source->Position), ReadLength);
+  Source->Position += *ReadLength;
+
+  return Status;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+LimitedSourceRewind (
+  IN  AUDIO_SOURCE  *This
+  )
+{
+  LIMITED_SOURCE  *Source;
+
+  //
+
+  Source            = BASE_CR (This, LIMITED_SOURCE, Source);
+  Source->Position  = 0;
+
+  return Source->Inner->Rewind (Source->Inner);
+}
+
+VOID
+LimitedSourceInit (
+  OUT LIMITED_SOURCE  *Source,
+  IN  AUDIO_SOURCE    *Inner,
+  IN  UINTN           MaxSamples
+  )
+{
+  UINTN   BlockAlign;
+
+  //
+
+  BlockAlign = Inner->Channels * AudioIoBytesPerSample (Inner->Bits);
+
+  CopyMem (&Source->Source, Inner, sizeof (Source->Source));
+  Source->Source.Read         = LimitedSourceRead;
+  Source->Source.Rewind       = LimitedSourceRewind;
+  Source->Source.TotalSamples = MIN (Inner->TotalSamples, MaxSamples);
+  Source->Inner               = Inner;
+  Source->Length              = Source->Source.TotalSamples * BlockAlign;
+  Source->Position            = 0;
+}
+
+/**
+  Submit the buffer at the play index to the device.
+  Must be called with the stream claimed as playing.
+**/
+STATIC
+EFI_STATUS
+AudioStreamSubmit (
+  IN  AUDIO_STREAM  *Stream
+  );
+
+/**
+  Fade in the first and out the last few milliseconds of the source, in
+  place on a buffer about to be queued, so playback neither starts nor ends
+  with a step that pops. The fade-out is applied once the source has run
+  dry, as lengths of decoded and resampled sources are only estimates. The
+  service loop holds back the last frames of each buffer until then, so the
+  whole fade-out window is always in the final buffer.
+**/
+STATIC
+VOID
+AudioStreamFade (
+  IN  AUDIO_STREAM  *Stream,
+  IN  UINT8         *Buffer,
+  IN  UINTN         Frames
+  )
+{
+  AUDIO_SOURCE  *Source;
+  UINTN         End;
+  UINTN         Start;
+
+  //
+
+  Source = Stream->Source;
+
+  if (Stream->ReadSamples < Stream->FadeSamples) {
+    FadeApply (Buffer, Source->Bits, Source->Channels, Frames, Stream->ReadSamples, Stream->FadeSamples, FALSE);
+  }
+
+  if (!Stream->SourceDone) {
+    return;
+  }
+
+  // Only frames actually read count, whatever the source length claimed.
+  End = Stream->ReadSamples + Frames;
+  if ((End == 0) || (End < Stream->FadeSamples)) {
+    return;
+  }
+
+  Start = MAX (End - Stream->FadeSamples, Stream->ReadSamples);
+  if (Start < (Stream->ReadSamples + Frames)) {
+    FadeApply (
+      Buffer + (Start - Stream->ReadSamples) * Stream->BlockAlign,
+      Source->Bits,
+      Source->Channels,
+      Stream->ReadSamples + Frames - Start,
+      Start - (End - Stream->FadeSamples),
+      Stream->FadeSamples,
+      TRUE
+      );
+  }
+}
+
+/**
+  Playback completion callback, invoked by the Audio I/O driver.
+
+  Releases the finished buffer and chains the next filled one right away, so
+  playback continues without waiting for the main loop. The main loop is then
+  signaled to refill the released buffer.
+**/
+STATIC
+VOID
+EFIAPI
+AudioStreamCallback (
+  IN  EFI_AUDIO_IO_PROTOCOL   *AudioIo,
+  IN  VOID                    *Context
+  )
+{
+  AUDIO_STREAM  *Stream;
+
+  //
+
+  Stream = (AUDIO_STREAM *)Context;
+
+  Stream->PlayedSamples += Stream->BufferLengths[Stream->PlayIndex] / Stream->BlockAlign;
+  Stream->FilledCount--;
+  Stream->PlayIndex = (Stream->PlayIndex + 1) % AUDIO_STREAM_BUFFER_COUNT;
+
+  if ((Stream->FilledCount > 0) && !Stream->Stopping) {
+    if (EFI_ERROR (AudioStreamSubmit (Stream))) {
+      // Let the main loop retry.
+      Stream->Playing = FALSE;
+    }
+  } else {
+    Stream->Playing = FALSE;
+  }
+
+  gBS->SignalEvent (Stream->RefillEvent);
+}
+
+STATIC
+EFI_STATUS
+AudioStreamSubmit (
+  IN  AUDIO_STREAM  *Stream
+  )
+{
+  EFI_STATUS    Status;
+
+  //
+
+  Status = Stream->AudioIo->StartPlaybackAsync (
+    Stream->AudioIo,
+    Stream->Buffers[Stream->PlayIndex],
+    Stream->BufferLengths[Stream->PlayIndex],
+    0,
+    AudioStreamCallback,
+    Stream
+    );
+  if (!EFI_ERROR (Status)) {
+    Stream->SubmittedSamples += Stream->BufferLengths[Stream->PlayIndex] / Stream->BlockAlign;
+  }
+
+  return Status;
+}
+
+EFI_STATUS
+AudioStreamCreate (
+  OUT AUDIO_STREAM            *Stream,
+  IN  EFI_AUDIO_IO_PROTOCOL   *AudioIo,
+  IN  AUDIO_SOURCE            *Source
+  )
+{
+  EFI_STATUS    Status;
+  UINTN         i;
+
+  //
+
+  if ((Stream == NULL) || (AudioIo == NULL) || (Source == NULL) || (Source->Channels == 0)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  ZeroMem (Stream, sizeof (*Stream));
+  Stream->AudioIo     = AudioIo;
+  Stream->Source      = Source;
+  Stream->BlockAlign  = Source->Channels * AudioIoBytesPerSample (Source->Bits);
+  Stream->FadeSamples = (UINTN)DivU64x32 (MultU64x32 (AudioIoFreqToHz (Source->Frequency), AUDIO_STREAM_FADE_LENGTH), 1000);
+
+  // Keep buffers a whole number of sample blocks.
+  Stream->BufferSize  = AUDIO_STREAM_BUFFER_SIZE - (AUDIO_STREAM_BUFFER_SIZE % Stream->BlockAlign);
+
+  // Frames held back for the fade-out must leave room for new ones.
+  Stream->FadeSamples = MIN (Stream->FadeSamples, Stream->BufferSize / Stream->BlockAlign / 2);
+
+  for (i = 0; i < AUDIO_STREAM_BUFFER_COUNT; i++) {
+    Stream->Buffers[i] = AllocatePool (Stream->BufferSize);
+    if (Stream->Buffers[i] == NULL) {
+      AudioStreamDestroy (Stream);
+      return EFI_OUT_OF_RESOURCES;
+    }
+  }
+
+  Status = gBS->CreateEvent (0, 0, NULL, NULL, &Stream->RefillEvent);
+  if (EFI_ERROR (Status)) {
+    Stream->RefillEvent = NULL;
+    AudioStreamDestroy (Stream);
+    return Status;
+  }
+
+  return Source->Rewind (Source);
+}
+
+EFI_STATUS
+AudioStreamService (
+  IN  AUDIO_STREAM  *Stream
+  )
+{
+  EFI_STATUS    Status;
+  EFI_TPL       OldTpl;
+  UINTN         Length;
+  UINTN         ReadLength;
+  UINTN         Frames;
+  UINTN         HeldIndex;
+  BOOLEAN       Start;
+
+  //
+
+  if (Stream->Stopping) {
+    return EFI_ABORTED;
+  }
+
+  // Refill idle buffers. The callback only ever releases buffers, so the fill side is ours.
+  while ((Stream->FilledCount < AUDIO_STREAM_BUFFER_COUNT) && !Stream->SourceDone) {
+    // Frames held back from the previous buffer go first, that buffer is never the one filled.
+    Length = Stream->HeldSamples * Stream->BlockAlign;
+    if (Length > 0) {
+      HeldIndex = (Stream->FillIndex + AUDIO_STREAM_BUFFER_COUNT - 1) % AUDIO_STREAM_BUFFER_COUNT;
+      CopyMem (
+        Stream->Buffers[Stream->FillIndex],
+        Stream->Buffers[HeldIndex] + Stream->BufferLengths[HeldIndex],
+        Length
+        );
+    }
+
+    do {
+      Status = Stream->Source->Read (
+        Stream->Source,
+        Stream->Buffers[Stream->FillIndex] + Length,
+        Stream->BufferSize - Length,
+        &ReadLength
+        );
+      Length += ReadLength;
+    } while (!EFI_ERROR (Status) && (ReadLength > 0) && (Length < Stream->BufferSize));
+
+    if (EFI_ERROR (Status) && (Status != EFI_END_OF_FILE)) {
+      return Status;
+    }
+
+    if (Length < Stream->BufferSize) {
+      Stream->SourceDone = TRUE;
+    }
+
+    // Drop trailing partial sample blocks.
+    Frames = Length / Stream->BlockAlign;
+
+    //
+    // Until the source runs dry, the last frames may still need the fade-out,
+    // so they wait for the next buffer. A full buffer always has more frames
+    // than the fade-out takes.
+    //
+    Stream->HeldSamples = Stream->SourceDone ? 0 : Stream->FadeSamples;
+    Frames             -= Stream->HeldSamples;
+
+    if (Frames == 0) {
+      break;
+    }
+
+    AudioStreamFade (Stream, Stream->Buffers[Stream->FillIndex], Frames);
+    Stream->ReadSamples += Frames;
+
+    Stream->BufferLengths[Stream->FillIndex] = Frames * Stream->BlockAlign;
+    Stream->FillIndex = (Stream->FillIndex + 1) % AUDIO_STREAM_BUFFER_COUNT;
+
+    OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+    Stream->FilledCount++;
+    gBS->RestoreTPL (OldTpl);
+  }
+
+  // Start playback when idle, e.g. first buffer or after an underrun.
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+  Start = !Stream->Playing && (Stream->FilledCount > 0);
+  if (Start) {
+    Stream->Playing = TRUE;
+  }
+  gBS->RestoreTPL (OldTpl);
+
+  if (Start) {
+    Status = AudioStreamSubmit (Stream);
+    if (EFI_ERROR (Status)) {
+      Stream->Playing = FALSE;
+      return Status;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+BOOLEAN
+AudioStreamIsDone (
+  IN  AUDIO_STREAM  *Stream
+  )
+{
+  return Stream->Stopping || (Stream->SourceDone && (Stream->FilledCount == 0) && !Stream->Playing);
+}
+
+VOID
+AudioStreamStop (
+  IN  AUDIO_STREAM  *Stream
+  )
+{
+  EFI_TPL   OldTpl;
+  BOOLEAN   Playing;
+
+  //
+
+  // Keep the callback from chaining further buffers.
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+  Stream->Stopping  = TRUE;
+  Playing           = Stream->Playing;
+  gBS->RestoreTPL (OldTpl);
+
+  if (Playing) {
+    Stream->AudioIo->StopPlayback (Stream->AudioIo);
+    Stream->Playing = FALSE;
+  }
+}
+
+/**
+  Stop playback with a fade-out, so a cancel does not pop. The buffer after
+  the one playing is cut to a fade-out and the source is dropped, so the
+  stream ends by itself shortly. Without such a buffer, playback stops
+  right away.
+**/
+VOID
+AudioStreamFadeOut (
+  IN  AUDIO_STREAM  *Stream
+  )
+{
+  EFI_TPL   OldTpl;
+  UINTN     Index;
+  UINTN     Frames;
+
+  //
+
+  // Keep the callback from moving on while the buffer is changed.
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+
+  Index = Stream->PlayIndex;
+  if (Stream->Playing) {
+    Index = (Index + 1) % AUDIO_STREAM_BUFFER_COUNT;
+  }
+
+  if (Stream->Stopping || (Stream->FadeSamples == 0) || (Stream->FilledCount <= (Stream->Playing ? 1U : 0U))) {
+    gBS->RestoreTPL (OldTpl);
+    AudioStreamStop (Stream);
+    return;
+  }
+
+  Frames = MIN (Stream->BufferLengths[Index] / Stream->BlockAlign, Stream->FadeSamples);
+  FadeApply (Stream->Buffers[Index], Stream->Source->Bits, Stream->Source->Channels, Frames, 0, Stream->FadeSamples, TRUE);
+
+  Stream->BufferLengths[Index]  = Frames * Stream->BlockAlign;
+  Stream->FilledCount           = Stream->Playing ? 2 : 1;
+  Stream->FillIndex             = (Index + 1) % AUDIO_STREAM_BUFFER_COUNT;
+  Stream->HeldSamples           = 0;
+  Stream->SourceDone            = TRUE;
+
+  gBS->RestoreTPL (OldTpl);
+}
+
+VOID
+AudioStreamDestroy (
+  IN  AUDIO_STREAM  *Stream
+  )
+{
+  UINTN   i;
+
+  //
+
+  if (Stream->Playing) {
+    AudioStreamStop (Stream);
+  }
+
+  for (i = 0; i < AUDIO_STREAM_BUFFER_COUNT; i++) {
+    if (Stream->Buffers[i] != NULL) {
+      FreePool (Stream->Buffers[i]);
+      Stream->Buffers[i] = NULL;
+    }
+  }
+
+  if (Stream->RefillEvent != NULL) {
+    gBS->CloseEvent (Stream->RefillEvent);
+    Stream->RefillEvent = NULL;
+  }
+}
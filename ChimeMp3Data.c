@@ -2549,8 +2549,10 @@ UINT8 mChimeData[] = { // OCEFIAudio_VoiceOver_Boot_mp3
 
 UINTN mChimeDataLength = 30407;
 
-//UINTN ChimeDataLength = 489992;
-//UINT8 ChimeDataChannels = 2;
-//EFI_AUDIO_IO_PROTOCOL_BITS ChimeDataBits = EfiAudioIoBits16;
-//EFI_AUDIO_IO_PROTOCOL_FREQ ChimeDataFreq = EfiAudioIoFreq48kHz;
+//
+// Encoded data, format is known after decoding.
+//
+EFI_AUDIO_IO_PROTOCOL_FREQ mChimeDataFreq = 0;
+EFI_AUDIO_IO_PROTOCOL_BITS mChimeDataBits = 0;
+UINT8 mChimeDataChannels = 0;
 
@@ -37280,3 +37280,10 @@ UINT8 mChimeData[] = {
 };
 
 UINTN mChimeDataLength = 447184;
+
+//
+// Encoded data, format is known after decoding.
+//
+EFI_AUDIO_IO_PROTOCOL_FREQ mChimeDataFreq = 0;
+EFI_AUDIO_IO_PROTOCOL_BITS mChimeDataBits = 0;
+UINT8 mChimeDataChannels = 0;
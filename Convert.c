@@ -0,0 +1,420 @@
+/*
+ * File: Convert.c
+ *
+ * Description: PCM sample format and channel conversion.
+ *
+ * Copyright (c) 2018-2019 John Davis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "AudioDxeCfg.h"
+
+INT32
+ConvertLoadSample (
+  IN  CONST UINT8                 *Sample,
+  IN  EFI_AUDIO_IO_PROTOCOL_BITS  Bits
+  )
+{
+  switch (Bits) {
+    // 8-bit samples are unsigned.
+    case EfiAudioIoBits8:
+      return (INT32)(((UINT32)*Sample ^ 0x80) << 24);
+
+    case EfiAudioIoBits16:
+      return (INT32)((UINT32)ReadUnaligned16 ((CONST UINT16 *)Sample) << 16);
+
+    default:
+      return (INT32)ReadUnaligned32 ((CONST UINT32 *)Sample);
+  }
+}
+
+VOID
+ConvertStoreSample (
+  OUT UINT8                       *Sample,
+  IN  EFI_AUDIO_IO_PROTOCOL_BITS  Bits,
+  IN  INT32                       Value
+  )
+{
+  switch (Bits) {
+    case EfiAudioIoBits8:
+      *Sample = (UINT8)(((UINT32)Value >> 24) ^ 0x80);
+      break;
+
+    case EfiAudioIoBits16:
+      WriteUnaligned16 ((UINT16 *)Sample, (UINT16)((UINT32)Value >> 16));
+      break;
+
+    case EfiAudioIoBits20:
+      WriteUnaligned32 ((UINT32 *)Sample, (UINT32)Value & 0xFFFFF000);
+      break;
+
+    case EfiAudioIoBits24:
+      WriteUnaligned32 ((UINT32 *)Sample, (UINT32)Value & 0xFFFFFF00);
+      break;
+
+    default:
+      WriteUnaligned32 ((UINT32 *)Sample, (UINT32)Value);
+      break;
+  }
+}
+
+//
+// Kernels for the common cases. Loops are kept simple and unrolled, so
+// compilers can vectorize them where the build allows it.
+//
+
+STATIC
+VOID
+Convert16To32 (
+  IN  CONST INT16   *In,
+  OUT INT32         *Out,
+  IN  UINTN         Count
+  )
+{
+  UINTN   i;
+
+  //
+
+  for (i = 0; (i + 4) <= Count; i += 4) {
+    Out[i]     = (INT32)((UINT32)(UINT16)In[i]     << 16);
+    Out[i + 1] = (INT32)((UINT32)(UINT16)In[i + 1] << 16);
+    Out[i + 2] = (INT32)((UINT32)(UINT16)In[i + 2] << 16);
+    Out[i + 3] = (INT32)((UINT32)(UINT16)In[i + 3] << 16);
+  }
+
+  for (; i < Count; i++) {
+    Out[i] = (INT32)((UINT32)(UINT16)In[i] << 16);
+  }
+}
+
+STATIC
+VOID
+Convert32To16 (
+  IN  CONST INT32   *In,
+  OUT INT16         *Out,
+  IN  UINTN         Count
+  )
+{
+  UINTN   i;
+
+  //
+
+  for (i = 0; (i + 4) <= Count; i += 4) {
+    Out[i]     = (INT16)(In[i]     >> 16);
+    Out[i + 1] = (INT16)(In[i + 1] >> 16);
+    Out[i + 2] = (INT16)(In[i + 2] >> 16);
+    Out[i + 3] = (INT16)(In[i + 3] >> 16);
+  }
+
+  for (; i < Count; i++) {
+    Out[i] = (INT16)(In[i] >> 16);
+  }
+}
+
+STATIC
+VOID
+Convert16MonoToStereo (
+  IN  CONST INT16   *In,
+  OUT INT16         *Out,
+  IN  UINTN         Frames
+  )
+{
+  UINTN   i;
+
+  //
+
+  for (i = 0; i < Frames; i++) {
+    Out[2 * i]      = In[i];
+    Out[2 * i + 1]  = In[i];
+  }
+}
+
+STATIC
+VOID
+Convert16StereoToMono (
+  IN  CONST INT16   *In,
+  OUT INT16         *Out,
+  IN  UINTN         Frames
+  )
+{
+  UINTN   i;
+
+  //
+
+  for (i = 0; i < Frames; i++) {
+    Out[i] = (INT16)(((INT32)In[2 * i] + In[2 * i + 1]) >> 1);
+  }
+}
+
+//
+// Left and right gains of input channels, Q8, in the usual WAV order: front
+// left and right, center, LFE, back left and right, side left and right.
+// Plain PCM WAV files carry no channel mask, so this order is assumed. The
+// LFE channel is left out, as are channels beyond the table.
+//
+STATIC CONST UINT16 mDownmixGains[][2] = {
+  { 256,   0 },
+  {   0, 256 },
+  { 181, 181 },
+  {   0,   0 },
+  { 181,   0 },
+  {   0, 181 },
+  { 181,   0 },
+  {   0, 181 }
+};
+
+/**
+  Mix surround samples down to stereo or mono, with gains scaled so the
+  mix cannot clip.
+**/
+STATIC
+VOID
+ConvertDownmix (
+  IN  CONST UINT8                 *In,
+  IN  EFI_AUDIO_IO_PROTOCOL_BITS  InBits,
+  IN  UINT8                       InChannels,
+  OUT UINT8                       *Out,
+  IN  EFI_AUDIO_IO_PROTOCOL_BITS  OutBits,
+  IN  UINT8                       OutChannels,
+  IN  UINTN                       Frames
+  )
+{
+  UINT32  Mix[ARRAY_SIZE (mDownmixGains)][AUDIO_OUTPUT_MAX_CHANNELS];
+  UINT32  Total[AUDIO_OUTPUT_MAX_CHANNELS];
+  UINTN   InSize;
+  UINTN   OutSize;
+  UINT8   Count;
+  INT32   Value;
+  UINTN   f;
+  UINT8   c;
+  UINT8   o;
+
+  //
+
+  Count = (UINT8)MIN (InChannels, ARRAY_SIZE (mDownmixGains));
+
+  // Mono takes both sides of the stereo mix.
+  ZeroMem (Total, sizeof (Total));
+  for (c = 0; c < Count; c++) {
+    for (o = 0; o < OutChannels; o++) {
+      Mix[c][o]  = (OutChannels == 1) ? (mDownmixGains[c][0] + mDownmixGains[c][1]) : mDownmixGains[c][o];
+      Total[o]  += Mix[c][o];
+    }
+  }
+
+  // Gains of each output add up to at most 128, so a 24-bit sum has headroom.
+  for (c = 0; c < Count; c++) {
+    for (o = 0; o < OutChannels; o++) {
+      Mix[c][o] = (Mix[c][o] * 128) / Total[o];
+    }
+  }
+
+  InSize  = AudioIoBytesPerSample (InBits);
+  OutSize = AudioIoBytesPerSample (OutBits);
+
+  for (f = 0; f < Frames; f++) {
+    for (o = 0; o < OutChannels; o++) {
+      Value = 0;
+      for (c = 0; c < Count; c++) {
+        Value += (ConvertLoadSample (&In[c * InSize], InBits) >> 8) * (INT32)Mix[c][o];
+      }
+      ConvertStoreSample (&Out[o * OutSize], OutBits, Value * 2);
+    }
+
+    In  += InChannels * InSize;
+    Out += OutChannels * OutSize;
+  }
+}
+
+VOID
+ConvertSamples (
+  IN  CONST UINT8                 *In,
+  IN  EFI_AUDIO_IO_PROTOCOL_BITS  InBits,
+  IN  UINT8                       InChannels,
+  OUT UINT8                       *Out,
+  IN  EFI_AUDIO_IO_PROTOCOL_BITS  OutBits,
+  IN  UINT8                       OutChannels,
+  IN  UINTN                       Frames
+  )
+{
+  UINTN   InSize;
+  UINTN   OutSize;
+  INT32   Value;
+  UINTN   f;
+  UINT8   c;
+
+  //
+
+  if (InChannels == OutChannels) {
+    if ((InBits == EfiAudioIoBits16) && (OutBits == EfiAudioIoBits32)) {
+      Convert16To32 ((CONST INT16 *)In, (INT32 *)Out, Frames * InChannels);
+      return;
+    }
+
+    if ((InBits == EfiAudioIoBits32) && (OutBits == EfiAudioIoBits16)) {
+      Convert32To16 ((CONST INT32 *)In, (INT16 *)Out, Frames * InChannels);
+      return;
+    }
+  } else if ((InBits == EfiAudioIoBits16) && (OutBits == EfiAudioIoBits16)) {
+    if ((InChannels == 1) && (OutChannels == 2)) {
+      Convert16MonoToStereo ((CONST INT16 *)In, (INT16 *)Out, Frames);
+      return;
+    }
+
+    if ((InChannels == 2) && (OutChannels == 1)) {
+      Convert16StereoToMono ((CONST INT16 *)In, (INT16 *)Out, Frames);
+      return;
+    }
+  }
+
+  if ((InChannels > 2) && (OutChannels <= AUDIO_OUTPUT_MAX_CHANNELS)) {
+    ConvertDownmix (In, InBits, InChannels, Out, OutBits, OutChannels, Frames);
+    return;
+  }
+
+  //
+  // Generic path. Output channels take the input channel at the same
+  // position, wrapping around, so mono is duplicated. Mono output averages
+  // the input channels.
+  //
+  InSize  = AudioIoBytesPerSample (InBits);
+  OutSize = AudioIoBytesPerSample (OutBits);
+
+  for (f = 0; f < Frames; f++) {
+    if ((OutChannels == 1) && (InChannels > 1)) {
+      Value = 0;
+      for (c = 0; c < InChannels; c++) {
+        Value += ConvertLoadSample (&In[c * InSize], InBits) / InChannels;
+      }
+      ConvertStoreSample (Out, OutBits, Value);
+    } else {
+      for (c = 0; c < OutChannels; c++) {
+        ConvertStoreSample (&Out[c * OutSize], OutBits, ConvertLoadSample (&In[(c % InChannels) * InSize], InBits));
+      }
+    }
+
+    In  += InChannels * InSize;
+    Out += OutChannels * OutSize;
+  }
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+ConvertSourceRead (
+  IN  AUDIO_SOURCE  *This,
+  OUT UINT8         *Buffer,
+  IN  UINTN         Length,
+  OUT UINTN         *ReadLength
+  )
+{
+  EFI_STATUS      Status;
+  CONVERT_SOURCE  *Source;
+  UINTN           InBlockAlign;
+  UINTN           OutBlockAlign;
+  UINTN           Frames;
+  UINTN           InLength;
+  UINTN           Read;
+
+  //
+
+  Source        = BASE_CR (This, CONVERT_SOURCE, Source);
+  InBlockAlign  = Source->Inner->Channels * AudioIoBytesPerSample (Source->Inner->Bits);
+  OutBlockAlign = This->Channels * AudioIoBytesPerSample (This->Bits);
+
+  // Read whole input frames for the output space, in scratch sized pieces.
+  Frames = MIN (Length / OutBlockAlign, Source->ScratchSize / InBlockAlign);
+  if (Frames == 0) {
+    *ReadLength = 0;
+    return EFI_BUFFER_TOO_SMALL;
+  }
+
+  InLength = 0;
+  do {
+    Status = Source->Inner->Read (Source->Inner, Source->Scratch + InLength, Frames * InBlockAlign - InLength, &Read);
+    InLength += Read;
+  } while (!EFI_ERROR (Status) && (Read > 0) && (InLength < Frames * InBlockAlign));
+
+  Frames = InLength / InBlockAlign;
+  ConvertSamples (Source->Scratch, Source->Inner->Bits, Source->Inner->Channels, Buffer, This->Bits, This->Channels, Frames);
+  *ReadLength = Frames * OutBlockAlign;
+
+  if ((Status == EFI_END_OF_FILE) && (*ReadLength > 0)) {
+    return EFI_SUCCESS;
+  }
+
+  return Status;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+ConvertSourceRewind (
+  IN  AUDIO_SOURCE  *This
+  )
+{
+  CONVERT_SOURCE  *Source;
+
+  //
+
+  Source = BASE_CR (This, CONVERT_SOURCE, Source);
+
+  return Source->Inner->Rewind (Source->Inner);
+}
+
+EFI_STATUS
+ConvertSourceInit (
+  OUT CONVERT_SOURCE              *Source,
+  IN  AUDIO_SOURCE                *Inner,
+  IN  EFI_AUDIO_IO_PROTOCOL_BITS  Bits,
+  IN  UINT8                       Channels
+  )
+{
+  if ((Inner->Channels == 0) || (Channels == 0)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  CopyMem (&Source->Source, Inner, sizeof (Source->Source));
+  Source->Source.Read     = ConvertSourceRead;
+  Source->Source.Rewind   = ConvertSourceRewind;
+  Source->Source.Bits     = Bits;
+  Source->Source.Channels = Channels;
+  Source->Inner           = Inner;
+
+  // Room for a stream buffer worth of input.
+  Source->ScratchSize = AUDIO_STREAM_BUFFER_SIZE;
+  Source->Scratch     = AllocatePool (Source->ScratchSize);
+  if (Source->Scratch == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  return EFI_SUCCESS;
+}
+
+VOID
+ConvertSourceFree (
+  IN  CONVERT_SOURCE  *Source
+  )
+{
+  if (Source->Scratch != NULL) {
+    FreePool (Source->Scratch);
+    Source->Scratch = NULL;
+  }
+}
@@ -0,0 +1,286 @@
+/*
+ * File: DeviceCache.c
+ *
+ * Description: Output enumeration cache, kept next to the application.
+ *
+ * Copyright (c) 2018-2019 John Davis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "AudioDxeCfg.h"
+
+//
+// File layout: a header, then per Audio I/O handle in enumeration order an
+// entry, its output ports and its device path text, padded to 4 bytes.
+// Handles are matched by device path size and CRC.
+//
+#define DEVICE_CACHE_SIGNATURE    SIGNATURE_32 ('A', 'D', 'C', 'C')
+#define DEVICE_CACHE_VERSION      (1)
+
+typedef struct {
+  UINT32    Signature;
+  UINT32    Version;
+  UINT32    Size;
+  UINT32    Crc;
+  UINT32    HandleCount;
+  UINT32    PortSize;
+} DEVICE_CACHE_HEADER;
+
+typedef struct {
+  UINT32    PathCrc;
+  UINT32    PathSize;
+  UINT32    PortCount;
+  UINT32    TextSize;
+} DEVICE_CACHE_ENTRY;
+
+/**
+  Identify a handle by its device path. Handles without one match empty entries.
+**/
+STATIC
+VOID
+DeviceCacheGetPathKey (
+  IN  AUDIO_IO_OUTPUTS  *Outputs,
+  OUT UINT32            *PathCrc,
+  OUT UINT32            *PathSize
+  )
+{
+  if (Outputs->DevicePath == NULL) {
+    *PathCrc  = 0;
+    *PathSize = 0;
+    return;
+  }
+
+  *PathSize = (UINT32)GetDevicePathSize (Outputs->DevicePath);
+  *PathCrc  = CalculateCrc32 (Outputs->DevicePath, *PathSize);
+}
+
+/**
+  Size of an entry with its ports and text.
+**/
+STATIC
+UINTN
+DeviceCacheEntrySize (
+  IN  CONST DEVICE_CACHE_ENTRY  *Entry
+  )
+{
+  return sizeof (*Entry) + Entry->PortCount * sizeof (EFI_AUDIO_IO_PROTOCOL_PORT) + ALIGN_VALUE (Entry->TextSize, sizeof (UINT32));
+}
+
+EFI_STATUS
+DeviceCacheLoad (
+  IN     EFI_FILE_PROTOCOL   *Dir,
+  IN OUT AUDIO_IO_OUTPUTS    *Outputs,
+  IN     UINTN               OutputsCount
+  )
+{
+  EFI_STATUS            Status;
+  EFI_FILE_PROTOCOL     *File;
+  UINT32                FileSize;
+  UINT8                 *Data;
+  DEVICE_CACHE_HEADER   *Header;
+  DEVICE_CACHE_ENTRY    *Entry;
+  UINTN                 Offset;
+  UINT32                PathCrc;
+  UINT32                PathSize;
+  UINTN                 h;
+
+  //
+
+  Status = SafeFileOpen (Dir, &File, DEVICE_CACHE_FILE_NAME, EFI_FILE_MODE_READ, 0);
+  if (EFI_ERROR (Status)) {
+    return EFI_NOT_FOUND;
+  }
+
+  Data    = NULL;
+  Status  = GetFileSize (File, &FileSize);
+  if (!EFI_ERROR (Status)) {
+    if ((FileSize < sizeof (*Header)) || (FileSize > DEVICE_CACHE_MAX_SIZE)) {
+      Status = EFI_VOLUME_CORRUPTED;
+    } else {
+      Data = AllocatePool (FileSize);
+      if (Data == NULL) {
+        Status = EFI_OUT_OF_RESOURCES;
+      } else {
+        Status = GetFileData (File, 0, FileSize, Data);
+      }
+    }
+  }
+
+  File->Close (File);
+
+  if (EFI_ERROR (Status)) {
+    goto DONE;
+  }
+
+  Header = (DEVICE_CACHE_HEADER *)Data;
+  if ((Header->Signature != DEVICE_CACHE_SIGNATURE)
+    || (Header->Version != DEVICE_CACHE_VERSION)
+    || (Header->Size != FileSize)
+    || (Header->PortSize != sizeof (EFI_AUDIO_IO_PROTOCOL_PORT))
+    || (Header->Crc != CalculateCrc32 (Data + sizeof (*Header), FileSize - sizeof (*Header)))) {
+    Status = EFI_VOLUME_CORRUPTED;
+    goto DONE;
+  }
+
+  //
+  // Check every handle before taking anything, so a mismatch leaves the
+  // outputs untouched for full enumeration.
+  //
+  if (Header->HandleCount != OutputsCount) {
+    Status = EFI_NOT_FOUND;
+    goto DONE;
+  }
+
+  Offset = sizeof (*Header);
+  for (h = 0; h < OutputsCount; h++) {
+    Entry = (DEVICE_CACHE_ENTRY *)(Data + Offset);
+    if (((Offset + sizeof (*Entry)) > FileSize)
+      || (Entry->PortCount > FileSize) || (Entry->TextSize > FileSize)
+      || ((Offset + DeviceCacheEntrySize (Entry)) > FileSize)) {
+      Status = EFI_VOLUME_CORRUPTED;
+      goto DONE;
+    }
+
+    DeviceCacheGetPathKey (&Outputs[h], &PathCrc, &PathSize);
+    if ((Entry->PathCrc != PathCrc) || (Entry->PathSize != PathSize)
+      || ((Outputs[h].AudioIo == NULL) && (Entry->PortCount > 0))) {
+      Status = EFI_NOT_FOUND;
+      goto DONE;
+    }
+
+    Offset += DeviceCacheEntrySize (Entry);
+  }
+
+  Offset = sizeof (*Header);
+  for (h = 0; h < OutputsCount; h++) {
+    Entry   = (DEVICE_CACHE_ENTRY *)(Data + Offset);
+    Offset += sizeof (*Entry);
+
+    if (Entry->PortCount > 0) {
+      Outputs[h].OutputPorts = AllocateCopyPool (Entry->PortCount * sizeof (EFI_AUDIO_IO_PROTOCOL_PORT), Data + Offset);
+      if (Outputs[h].OutputPorts == NULL) {
+        Status = EFI_OUT_OF_RESOURCES;
+        goto DONE;
+      }
+      Outputs[h].OutputPortsCount = Entry->PortCount;
+    }
+    Offset += Entry->PortCount * sizeof (EFI_AUDIO_IO_PROTOCOL_PORT);
+
+    // Text is terminated by the writer, but not trusted to be.
+    if (Entry->TextSize >= sizeof (CHAR16)) {
+      Outputs[h].DevicePathText = AllocateCopyPool (Entry->TextSize, Data + Offset);
+      if (Outputs[h].DevicePathText == NULL) {
+        Status = EFI_OUT_OF_RESOURCES;
+        goto DONE;
+      }
+      Outputs[h].DevicePathText[Entry->TextSize / sizeof (CHAR16) - 1] = L'\0';
+    }
+    Offset += ALIGN_VALUE (Entry->TextSize, sizeof (UINT32));
+  }
+
+  Status = EFI_SUCCESS;
+
+  DONE:
+
+  if (EFI_ERROR (Status)) {
+    for (h = 0; h < OutputsCount; h++) {
+      if (Outputs[h].OutputPorts != NULL) {
+        FreePool (Outputs[h].OutputPorts);
+        Outputs[h].OutputPorts = NULL;
+      }
+      Outputs[h].OutputPortsCount = 0;
+
+      if (Outputs[h].DevicePathText != NULL) {
+        FreePool (Outputs[h].DevicePathText);
+        Outputs[h].DevicePathText = NULL;
+      }
+    }
+  }
+
+  if (Data != NULL) {
+    FreePool (Data);
+  }
+
+  return Status;
+}
+
+EFI_STATUS
+DeviceCacheSave (
+  IN  EFI_FILE_PROTOCOL   *Dir,
+  IN  AUDIO_IO_OUTPUTS    *Outputs,
+  IN  UINTN               OutputsCount
+  )
+{
+  EFI_STATUS            Status;
+  UINT8                 *Data;
+  UINTN                 Size;
+  DEVICE_CACHE_HEADER   *Header;
+  DEVICE_CACHE_ENTRY    *Entry;
+  UINTN                 Offset;
+  UINTN                 h;
+
+  //
+
+  Size = sizeof (*Header);
+  for (h = 0; h < OutputsCount; h++) {
+    Size += sizeof (*Entry) + Outputs[h].OutputPortsCount * sizeof (EFI_AUDIO_IO_PROTOCOL_PORT);
+    if (Outputs[h].DevicePathText != NULL) {
+      Size += ALIGN_VALUE (StrSize (Outputs[h].DevicePathText), sizeof (UINT32));
+    }
+  }
+
+  if (Size > DEVICE_CACHE_MAX_SIZE) {
+    return EFI_BUFFER_TOO_SMALL;
+  }
+
+  Data = AllocateZeroPool (Size);
+  if (Data == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Offset = sizeof (*Header);
+  for (h = 0; h < OutputsCount; h++) {
+    Entry             = (DEVICE_CACHE_ENTRY *)(Data + Offset);
+    Entry->PortCount  = (UINT32)Outputs[h].OutputPortsCount;
+    Entry->TextSize   = (Outputs[h].DevicePathText != NULL) ? (UINT32)StrSize (Outputs[h].DevicePathText) : 0;
+    DeviceCacheGetPathKey (&Outputs[h], &Entry->PathCrc, &Entry->PathSize);
+    Offset += sizeof (*Entry);
+
+    CopyMem (Data + Offset, Outputs[h].OutputPorts, Entry->PortCount * sizeof (EFI_AUDIO_IO_PROTOCOL_PORT));
+    Offset += Entry->PortCount * sizeof (EFI_AUDIO_IO_PROTOCOL_PORT);
+
+    CopyMem (Data + Offset, Outputs[h].DevicePathText, Entry->TextSize);
+    Offset += ALIGN_VALUE (Entry->TextSize, sizeof (UINT32));
+  }
+
+  Header              = (DEVICE_CACHE_HEADER *)Data;
+  Header->Signature   = DEVICE_CACHE_SIGNATURE;
+  Header->Version     = DEVICE_CACHE_VERSION;
+  Header->Size        = (UINT32)Size;
+  Header->HandleCount = (UINT32)OutputsCount;
+  Header->PortSize    = sizeof (EFI_AUDIO_IO_PROTOCOL_PORT);
+  Header->Crc         = CalculateCrc32 (Data + sizeof (*Header), Size - sizeof (*Header));
+
+  Status = SetFileData (Dir, DEVICE_CACHE_FILE_NAME, Data, (UINT32)Size);
+
+  FreePool (Data);
+
+  return Status;
+}
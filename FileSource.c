@@ -0,0 +1,202 @@
+/*
+ * File: FileSource.c
+ *
+ * Description: PCM WAV sampler streamed from a file.
+ *
+ * Copyright (c) 2018-2019 John Davis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "AudioDxeCfg.h"
+
+/**
+  Bytes to read for a request, in whole frames. Large reads are trimmed to
+  end on an alignment boundary of the file, so following reads start on one.
+**/
+STATIC
+UINTN
+FileSourceReadLength (
+  IN  FILE_SOURCE   *Source,
+  IN  UINTN         Length
+  )
+{
+  UINT64    Start;
+  UINT64    End;
+
+  //
+
+  Length  = (UINTN)MIN (Length, Source->DataLength - Source->Position);
+  Length -= Length % Source->BlockAlign;
+
+  Start = Source->DataOffset + Source->Position;
+  End   = (Start + Length) & ~((UINT64)FILE_SOURCE_ALIGNMENT - 1);
+  while ((End > Start) && (((End - Start) % Source->BlockAlign) != 0)) {
+    End -= FILE_SOURCE_ALIGNMENT;
+  }
+
+  if ((End > Start) && ((Start + Length) < (Source->DataOffset + Source->DataLength))) {
+    return (UINTN)(End - Start);
+  }
+
+  return Length;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+FileSourceRead (
+  IN  AUDIO_SOURCE  *This,
+  OUT UINT8         *Buffer,
+  IN  UINTN         Length,
+  OUT UINTN         *ReadLength
+  )
+{
+  EFI_STATUS    Status;
+  FILE_SOURCE   *Source;
+  UINT64        StartTicks;
+
+  //
+
+  Source = BASE_CR (This, FILE_SOURCE, Source);
+
+  *ReadLength = FileSourceReadLength (Source, Length);
+  if (*ReadLength == 0) {
+    return (Source->Position >= Source->DataLength) ? EFI_END_OF_FILE : EFI_BUFFER_TOO_SMALL;
+  }
+
+  // Samples are read straight into the caller's buffer, no staging copy.
+  StartTicks  = GetPerformanceCounter ();
+  Status      = Source->File->Read (Source->File, ReadLength, Buffer);
+  Source->ReadTicks += GetPerformanceCounter () - StartTicks;
+  if (EFI_ERROR (Status)) {
+    *ReadLength = 0;
+    return Status;
+  }
+
+  // Files shorter than their data chunk end early.
+  *ReadLength        -= *ReadLength % Source->BlockAlign;
+  Source->Position   += *ReadLength;
+  Source->ReadBytes  += *ReadLength;
+  Source->ReadCount++;
+
+  if (*ReadLength == 0) {
+    Source->DataLength = Source->Position;
+    return EFI_END_OF_FILE;
+  }
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+FileSourceRewind (
+  IN  AUDIO_SOURCE  *This
+  )
+{
+  FILE_SOURCE   *Source;
+
+  //
+
+  Source            = BASE_CR (This, FILE_SOURCE, Source);
+  Source->Position  = 0;
+
+  return Source->File->SetPosition (Source->File, Source->DataOffset);
+}
+
+EFI_STATUS
+FileSourceOpen (
+  OUT FILE_SOURCE         *Source,
+  IN  EFI_FILE_PROTOCOL   *File
+  )
+{
+  EFI_STATUS                  Status;
+  UINT8                       *Probe;
+  UINTN                       ProbeLength;
+  UINT32                      FileSize;
+  WAVE_INFO                   WaveInfo;
+  EFI_AUDIO_IO_PROTOCOL_FREQ  Frequency;
+  EFI_AUDIO_IO_PROTOCOL_BITS  Bits;
+
+  //
+
+  ZeroMem (Source, sizeof (*Source));
+
+  Status = GetFileSize (File, &FileSize);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  // Only the header is read here, it normally fits well within the probe.
+  Probe = AllocatePool (CHIME_FILE_PROBE_SIZE);
+  if (Probe == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  ProbeLength = MIN (CHIME_FILE_PROBE_SIZE, FileSize);
+  Status      = File->SetPosition (File, 0);
+  if (!EFI_ERROR (Status)) {
+    Status = File->Read (File, &ProbeLength, Probe);
+  }
+  if (!EFI_ERROR (Status)) {
+    Status = WaveParse (Probe, ProbeLength, &WaveInfo);
+  }
+  if (!EFI_ERROR (Status)) {
+    Status = WaveGetAudioIoFormat (&WaveInfo, &Frequency, &Bits);
+  }
+
+  // The parsed length stops at the probe end, the chunk header has the full one.
+  if (!EFI_ERROR (Status)) {
+    Source->DataLength = MIN (
+      ReadUnaligned32 ((CONST UINT32 *)&Probe[WaveInfo.DataOffset - 4]),
+      FileSize - WaveInfo.DataOffset
+      );
+  }
+
+  FreePool (Probe);
+
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Source->Source.Read         = FileSourceRead;
+  Source->Source.Rewind       = FileSourceRewind;
+  Source->Source.Frequency    = Frequency;
+  Source->Source.Bits         = Bits;
+  Source->Source.Channels     = (UINT8)WaveInfo.Channels;
+  Source->File                = File;
+  Source->DataOffset          = WaveInfo.DataOffset;
+  Source->BlockAlign          = WaveInfo.BlockAlign;
+  Source->DataLength         -= Source->DataLength % Source->BlockAlign;
+  Source->Source.TotalSamples = (UINTN)(Source->DataLength / Source->BlockAlign);
+
+  return FileSourceRewind (&Source->Source);
+}
+
+VOID
+FileSourceClose (
+  IN  FILE_SOURCE   *Source
+  )
+{
+  if (Source->File != NULL) {
+    Source->File->Close (Source->File);
+    Source->File = NULL;
+  }
+}
@@ -0,0 +1,237 @@
+/*
+ * File: Gain.c
+ *
+ * Description: Software volume scaling of PCM samples.
+ *
+ * Copyright (c) 2018-2019 John Davis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "AudioDxeCfg.h"
+
+//
+// Gain per volume level in 16.16 fixed point, 0.6 dB steps spanning 60 dB
+// below full scale. Level 0 mutes.
+//
+STATIC CONST UINT32 mGainTable[EFI_AUDIO_IO_PROTOCOL_MAX_VOLUME + 1] = {
+  0,     70,    75,    81,    86,    93,    99,    106,   114,   122,
+  131,   140,   150,   161,   172,   185,   198,   212,   227,   243,
+  261,   280,   300,   321,   344,   369,   395,   423,   453,   486,
+  521,   558,   598,   640,   686,   735,   788,   844,   905,   969,
+  1039,  1113,  1193,  1278,  1369,  1467,  1572,  1685,  1805,  1934,
+  2072,  2221,  2379,  2550,  2732,  2927,  3137,  3361,  3601,  3859,
+  4135,  4431,  4748,  5087,  5451,  5841,  6259,  6706,  7186,  7700,
+  8250,  8841,  9473,  10150, 10876, 11654, 12488, 13381, 14338, 15363,
+  16462, 17639, 18901, 20253, 21701, 23253, 24916, 26698, 28608, 30653,
+  32846, 35195, 37712, 40409, 43299, 46396, 49714, 53270, 57079, 61162,
+  GAIN_UNITY
+};
+
+UINT32
+GainFromVolume (
+  IN  UINT8   Volume
+  )
+{
+  return mGainTable[MIN (Volume, EFI_AUDIO_IO_PROTOCOL_MAX_VOLUME)];
+}
+
+/**
+  Scale 16-bit samples. Unrolled by four, which compilers turn into
+  vector code where the build allows it.
+**/
+STATIC
+VOID
+GainApply16 (
+  IN OUT INT16  *Samples,
+  IN     UINTN  Count,
+  IN     INT32  Gain
+  )
+{
+  UINTN   i;
+
+  //
+
+  for (i = 0; (i + 4) <= Count; i += 4) {
+    Samples[i]     = (INT16)((Samples[i]     * Gain) >> 16);
+    Samples[i + 1] = (INT16)((Samples[i + 1] * Gain) >> 16);
+    Samples[i + 2] = (INT16)((Samples[i + 2] * Gain) >> 16);
+    Samples[i + 3] = (INT16)((Samples[i + 3] * Gain) >> 16);
+  }
+
+  for (; i < Count; i++) {
+    Samples[i] = (INT16)((Samples[i] * Gain) >> 16);
+  }
+}
+
+/**
+  Scale samples in 32-bit containers. The product is split in high and low
+  halves, so no 64-bit arithmetic is needed on 32-bit targets.
+**/
+STATIC
+VOID
+GainApply32 (
+  IN OUT INT32  *Samples,
+  IN     UINTN  Count,
+  IN     INT32  Gain
+  )
+{
+  UINTN   i;
+
+  //
+
+  for (i = 0; i < Count; i++) {
+    Samples[i] = ((Samples[i] >> 16) * Gain) + (INT32)(((UINT32)(Samples[i] & 0xFFFF) * (UINT32)Gain) >> 16);
+  }
+}
+
+VOID
+GainApply (
+  IN OUT UINT8                       *Buffer,
+  IN     UINTN                       Length,
+  IN     EFI_AUDIO_IO_PROTOCOL_BITS  Bits,
+  IN     UINT32                      Gain
+  )
+{
+  UINTN   i;
+
+  //
+
+  if (Gain >= GAIN_UNITY) {
+    return;
+  }
+
+  switch (Bits) {
+    // 8-bit samples are unsigned.
+    case EfiAudioIoBits8:
+      for (i = 0; i < Length; i++) {
+        Buffer[i] = (UINT8)(((((INT32)Buffer[i] - 0x80) * (INT32)Gain) >> 16) + 0x80);
+      }
+      break;
+
+    case EfiAudioIoBits16:
+      GainApply16 ((INT16 *)Buffer, Length / sizeof (INT16), (INT32)Gain);
+      break;
+
+    default:
+      GainApply32 ((INT32 *)Buffer, Length / sizeof (INT32), (INT32)Gain);
+      break;
+  }
+}
+
+//
+// Raised cosine fade-in envelope in 16.16 fixed point, from silence to unity.
+//
+STATIC CONST UINT32 mFadeTable[FADE_STEPS + 1] = {
+  0,     39,    158,   355,   630,   982,   1411,  1915,  2494,  3146,
+  3869,  4662,  5522,  6448,  7438,  8489,  9598,  10762, 11980, 13248,
+  14563, 15922, 17321, 18758, 20228, 21729, 23256, 24806, 26375, 27960,
+  29556, 31160, 32768, 34376, 35980, 37576, 39161, 40730, 42280, 43807,
+  45308, 46778, 48215, 49614, 50973, 52288, 53556, 54774, 55938, 57047,
+  58098, 59088, 60014, 60874, 61667, 62390, 63042, 63621, 64125, 64554,
+  64906, 65181, 65378, 65497, GAIN_UNITY
+};
+
+/**
+  Apply the fade envelope in place to frames at Position of a fade Length
+  frames long. Fade-outs run the envelope backwards, Position counting from
+  their start as well.
+**/
+VOID
+FadeApply (
+  IN OUT UINT8                       *Buffer,
+  IN     EFI_AUDIO_IO_PROTOCOL_BITS  Bits,
+  IN     UINT8                       Channels,
+  IN     UINTN                       Frames,
+  IN     UINTN                       Position,
+  IN     UINTN                       Length,
+  IN     BOOLEAN                     FadeOut
+  )
+{
+  UINTN   BlockAlign;
+  UINTN   Step;
+  UINTN   i;
+
+  //
+
+  BlockAlign = Channels * AudioIoBytesPerSample (Bits);
+
+  for (i = 0; (i < Frames) && ((Position + i) < Length); i++) {
+    Step = ((Position + i) * FADE_STEPS) / Length;
+    if (FadeOut) {
+      Step = FADE_STEPS - Step;
+    }
+
+    GainApply (Buffer + i * BlockAlign, BlockAlign, Bits, mFadeTable[Step]);
+  }
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+GainSourceRead (
+  IN  AUDIO_SOURCE  *This,
+  OUT UINT8         *Buffer,
+  IN  UINTN         Length,
+  OUT UINTN         *ReadLength
+  )
+{
+  EFI_STATUS    Status;
+  GAIN_SOURCE   *Source;
+
+  //
+
+  Source  = BASE_CR (This, GAIN_SOURCE, Source);
+  Status  = Source->Inner->Read (Source->Inner, Buffer, Length, ReadLength);
+  if (!EFI_ERROR (Status)) {
+    GainApply (Buffer, *ReadLength, This->Bits, Source->Gain);
+  }
+
+  return Status;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+GainSourceRewind (
+  IN  AUDIO_SOURCE  *This
+  )
+{
+  GAIN_SOURCE   *Source;
+
+  //
+
+  Source = BASE_CR (This, GAIN_SOURCE, Source);
+
+  return Source->Inner->Rewind (Source->Inner);
+}
+
+VOID
+GainSourceInit (
+  OUT GAIN_SOURCE   *Source,
+  IN  AUDIO_SOURCE  *Inner,
+  IN  UINT32        Gain
+  )
+{
+  CopyMem (&Source->Source, Inner, sizeof (Source->Source));
+  Source->Source.Read   = GainSourceRead;
+  Source->Source.Rewind = GainSourceRewind;
+  Source->Inner         = Inner;
+  Source->Gain          = Gain;
+}
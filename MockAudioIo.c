@@ -0,0 +1,394 @@
+/*
+ * File: MockAudioIo.c
+ *
+ * Description: Mock Audio I/O protocol for testing without audio hardware.
+ *
+ * Copyright (c) 2018-2019 John Davis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "AudioDxeCfg.h"
+
+#ifdef AUDIODXECFG_MOCK_AUDIO_IO
+
+#define MOCK_AUDIO_IO_SIGNATURE   SIGNATURE_32 ('M', 'A', 'I', 'O')
+
+#define MOCK_AUDIO_IO_FREQS       (EfiAudioIoFreq44kHz | EfiAudioIoFreq48kHz | EfiAudioIoFreq96kHz)
+#define MOCK_AUDIO_IO_BITS        (EfiAudioIoBits16 | EfiAudioIoBits24)
+
+#pragma pack(1)
+
+// Controller node carrying the codec index, followed by the codec node.
+typedef struct {
+  VENDOR_DEVICE_PATH          Controller;
+  UINT32                      CodecIndex;
+  VENDOR_DEVICE_PATH          Codec;
+  EFI_DEVICE_PATH_PROTOCOL    End;
+} MOCK_DEVICE_PATH;
+
+#pragma pack()
+
+typedef struct {
+  UINT32                      Signature;
+  EFI_AUDIO_IO_PROTOCOL       AudioIo;
+  EFI_HANDLE                  Handle;
+  MOCK_DEVICE_PATH            DevicePath;
+  UINTN                       PortCount;
+
+  // Current playback.
+  UINT32                      Frequency;
+  UINTN                       BlockAlign;
+  EFI_EVENT                   PlaybackTimer;
+  EFI_AUDIO_IO_CALLBACK       Callback;
+  VOID                        *Context;
+  volatile BOOLEAN            Playing;
+
+  // Recorded calls.
+  UINTN                       SetupCount;
+  UINTN                       StartCount;
+  UINTN                       StopCount;
+  UINT64                      SetupTicks;
+  UINT64                      StartTicks;
+  UINT64                      BytesPlayed;
+} MOCK_AUDIO_IO;
+
+#define MOCK_AUDIO_IO_FROM_THIS(a)  CR (a, MOCK_AUDIO_IO, AudioIo, MOCK_AUDIO_IO_SIGNATURE)
+
+STATIC EFI_GUID         mMockAudioIoGuid  = { 0x8F3C2B1E, 0x5A47, 0x4D2E, { 0x9B, 0x61, 0x3E, 0x0A, 0x7C, 0x44, 0xD2, 0x18 } };
+STATIC MOCK_AUDIO_IO    *mMockAudioIo     = NULL;
+STATIC UINTN            mMockAudioIoCount = 0;
+
+STATIC
+EFI_STATUS
+EFIAPI
+MockAudioIoGetOutputs (
+  IN  EFI_AUDIO_IO_PROTOCOL         *This,
+  OUT EFI_AUDIO_IO_PROTOCOL_PORT    **OutputPorts,
+  OUT UINTN                         *OutputPortsCount
+  )
+{
+  MOCK_AUDIO_IO                 *Mock;
+  EFI_AUDIO_IO_PROTOCOL_PORT    *Ports;
+  UINTN                         i;
+
+  //
+
+  if ((This == NULL) || (OutputPorts == NULL) || (OutputPortsCount == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Mock  = MOCK_AUDIO_IO_FROM_THIS (This);
+  Ports = AllocatePool (Mock->PortCount * sizeof (EFI_AUDIO_IO_PROTOCOL_PORT));
+  if (Ports == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  // Cycle through port kinds so listings look like a real codec.
+  for (i = 0; i < Mock->PortCount; i++) {
+    Ports[i].Type           = EfiAudioIoTypeOutput;
+    Ports[i].Device         = (EFI_AUDIO_IO_PROTOCOL_DEVICE)(i % EfiAudioIoDeviceMaximum);
+    Ports[i].Location       = (EFI_AUDIO_IO_PROTOCOL_LOCATION)(i % EfiAudioIoLocationMaximum);
+    Ports[i].Surface        = (EFI_AUDIO_IO_PROTOCOL_SURFACE)(i % EfiAudioIoSurfaceMaximum);
+    Ports[i].SupportedFreqs = MOCK_AUDIO_IO_FREQS;
+    Ports[i].SupportedBits  = MOCK_AUDIO_IO_BITS;
+  }
+
+  *OutputPorts      = Ports;
+  *OutputPortsCount = Mock->PortCount;
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+MockAudioIoSetupPlayback (
+  IN  EFI_AUDIO_IO_PROTOCOL       *This,
+  IN  UINT8                       OutputIndex,
+  IN  UINT8                       Volume,
+  IN  EFI_AUDIO_IO_PROTOCOL_FREQ  Freq,
+  IN  EFI_AUDIO_IO_PROTOCOL_BITS  Bits,
+  IN  UINT8                       Channels
+  )
+{
+  MOCK_AUDIO_IO   *Mock;
+  UINT64          StartTicks;
+
+  //
+
+  StartTicks  = GetPerformanceCounter ();
+  Mock        = MOCK_AUDIO_IO_FROM_THIS (This);
+
+  Mock->SetupCount++;
+
+  if ((OutputIndex >= Mock->PortCount) || (Volume > EFI_AUDIO_IO_PROTOCOL_MAX_VOLUME) || (Channels == 0)
+    || ((Freq & MOCK_AUDIO_IO_FREQS) == 0) || ((Bits & MOCK_AUDIO_IO_BITS) == 0)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  Mock->Frequency   = AudioIoFreqToHz (Freq);
+  Mock->BlockAlign  = Channels * AudioIoBytesPerSample (Bits);
+  Mock->SetupTicks += GetPerformanceCounter () - StartTicks;
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+VOID
+EFIAPI
+MockAudioIoPlaybackDone (
+  IN  EFI_EVENT   Event,
+  IN  VOID        *Context
+  )
+{
+  MOCK_AUDIO_IO   *Mock;
+
+  //
+
+  Mock          = (MOCK_AUDIO_IO *)Context;
+  Mock->Playing = FALSE;
+
+  if (Mock->Callback != NULL) {
+    Mock->Callback (&Mock->AudioIo, Mock->Context);
+  }
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+MockAudioIoStartPlaybackAsync (
+  IN  EFI_AUDIO_IO_PROTOCOL   *This,
+  IN  VOID                    *Data,
+  IN  UINTN                   DataLength,
+  IN  UINTN                   Position OPTIONAL,
+  IN  EFI_AUDIO_IO_CALLBACK   Callback OPTIONAL,
+  IN  VOID                    *Context OPTIONAL
+  )
+{
+  MOCK_AUDIO_IO   *Mock;
+  UINT64          Duration;
+  UINT64          StartTicks;
+
+  //
+
+  StartTicks  = GetPerformanceCounter ();
+  Mock        = MOCK_AUDIO_IO_FROM_THIS (This);
+
+  Mock->StartCount++;
+
+  if ((Data == NULL) || (DataLength == 0) || (Position > DataLength)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if ((Mock->Frequency == 0) || Mock->Playing) {
+    return EFI_NOT_READY;
+  }
+
+  // Complete after the time real hardware would take, in 100 ns units.
+  Duration = DivU64x32 (
+               MultU64x32 ((DataLength - Position) / Mock->BlockAlign, 10000000),
+               Mock->Frequency
+               );
+
+  Mock->Callback      = Callback;
+  Mock->Context       = Context;
+  Mock->Playing       = TRUE;
+  Mock->BytesPlayed  += DataLength - Position;
+
+  gBS->SetTimer (Mock->PlaybackTimer, TimerRelative, MAX (Duration, 1));
+
+  Mock->StartTicks += GetPerformanceCounter () - StartTicks;
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+MockAudioIoStartPlayback (
+  IN  EFI_AUDIO_IO_PROTOCOL   *This,
+  IN  VOID                    *Data,
+  IN  UINTN                   DataLength,
+  IN  UINTN                   Position OPTIONAL
+  )
+{
+  EFI_STATUS      Status;
+  MOCK_AUDIO_IO   *Mock;
+
+  //
+
+  Status = MockAudioIoStartPlaybackAsync (This, Data, DataLength, Position, NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Mock = MOCK_AUDIO_IO_FROM_THIS (This);
+  while (Mock->Playing) {
+    gBS->Stall (1000);
+  }
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+MockAudioIoStopPlayback (
+  IN  EFI_AUDIO_IO_PROTOCOL   *This
+  )
+{
+  MOCK_AUDIO_IO   *Mock;
+
+  //
+
+  Mock = MOCK_AUDIO_IO_FROM_THIS (This);
+
+  Mock->StopCount++;
+  gBS->SetTimer (Mock->PlaybackTimer, TimerCancel, 0);
+  Mock->Playing = FALSE;
+
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+MockAudioIoInstall (
+  IN  UINTN   CodecCount,
+  IN  UINTN   PortCount
+  )
+{
+  EFI_STATUS      Status;
+  MOCK_AUDIO_IO   *Mock;
+  UINTN           i;
+
+  //
+
+  if ((mMockAudioIo != NULL) || (CodecCount == 0) || (PortCount == 0) || (PortCount > MAX_UINT8)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  mMockAudioIo = AllocateZeroPool (CodecCount * sizeof (MOCK_AUDIO_IO));
+  if (mMockAudioIo == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  for (i = 0; i < CodecCount; i++) {
+    Mock                              = &mMockAudioIo[i];
+    Mock->Signature                   = MOCK_AUDIO_IO_SIGNATURE;
+    Mock->PortCount                   = PortCount;
+    Mock->AudioIo.GetOutputs          = MockAudioIoGetOutputs;
+    Mock->AudioIo.SetupPlayback       = MockAudioIoSetupPlayback;
+    Mock->AudioIo.StartPlayback       = MockAudioIoStartPlayback;
+    Mock->AudioIo.StartPlaybackAsync  = MockAudioIoStartPlaybackAsync;
+    Mock->AudioIo.StopPlayback        = MockAudioIoStopPlayback;
+
+    Mock->DevicePath.Controller.Header.Type     = HARDWARE_DEVICE_PATH;
+    Mock->DevicePath.Controller.Header.SubType  = HW_VENDOR_DP;
+    SetDevicePathNodeLength (&Mock->DevicePath.Controller, sizeof (VENDOR_DEVICE_PATH) + sizeof (UINT32));
+    CopyGuid (&Mock->DevicePath.Controller.Guid, &mMockAudioIoGuid);
+    Mock->DevicePath.CodecIndex                 = (UINT32)i;
+    Mock->DevicePath.Codec.Header.Type          = MESSAGING_DEVICE_PATH;
+    Mock->DevicePath.Codec.Header.SubType       = MSG_VENDOR_DP;
+    SetDevicePathNodeLength (&Mock->DevicePath.Codec, sizeof (VENDOR_DEVICE_PATH));
+    CopyGuid (&Mock->DevicePath.Codec.Guid, &mMockAudioIoGuid);
+    SetDevicePathEndNode (&Mock->DevicePath.End);
+
+    Status = gBS->CreateEvent (EVT_TIMER | EVT_NOTIFY_SIGNAL, TPL_NOTIFY, MockAudioIoPlaybackDone, Mock, &Mock->PlaybackTimer);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+
+    Status = gBS->InstallMultipleProtocolInterfaces (
+      &Mock->Handle,
+      &gEfiAudioIoProtocolGuid,
+      &Mock->AudioIo,
+      &gEfiDevicePathProtocolGuid,
+      &Mock->DevicePath,
+      NULL
+      );
+    if (EFI_ERROR (Status)) {
+      gBS->CloseEvent (Mock->PlaybackTimer);
+      break;
+    }
+
+    mMockAudioIoCount++;
+  }
+
+  if (EFI_ERROR (Status)) {
+    MockAudioIoUninstall ();
+  }
+
+  return Status;
+}
+
+VOID
+MockAudioIoPrintStats (
+  VOID
+  )
+{
+  MOCK_AUDIO_IO   *Mock;
+  UINTN           i;
+
+  //
+
+  for (i = 0; i < mMockAudioIoCount; i++) {
+    Mock = &mMockAudioIo[i];
+    Print (L"Mock codec %lu: setup (%lu) %lu ns, start (%lu) %lu ns, stop (%lu), played %lu bytes\n",
+      i,
+      Mock->SetupCount,
+      GetTimeInNanoSecond (Mock->SetupTicks),
+      Mock->StartCount,
+      GetTimeInNanoSecond (Mock->StartTicks),
+      Mock->StopCount,
+      Mock->BytesPlayed);
+  }
+}
+
+VOID
+MockAudioIoUninstall (
+  VOID
+  )
+{
+  MOCK_AUDIO_IO   *Mock;
+  UINTN           i;
+
+  //
+
+  for (i = 0; i < mMockAudioIoCount; i++) {
+    Mock = &mMockAudioIo[i];
+    gBS->CloseEvent (Mock->PlaybackTimer);
+    gBS->UninstallMultipleProtocolInterfaces (
+      Mock->Handle,
+      &gEfiAudioIoProtocolGuid,
+      &Mock->AudioIo,
+      &gEfiDevicePathProtocolGuid,
+      &Mock->DevicePath,
+      NULL
+      );
+  }
+
+  if (mMockAudioIo != NULL) {
+    FreePool (mMockAudioIo);
+  }
+
+  mMockAudioIo      = NULL;
+  mMockAudioIoCount = 0;
+}
+
+#endif
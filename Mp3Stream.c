@@ -0,0 +1,431 @@
+/*
+ * File: Mp3Stream.c
+ *
+ * Description: Chunked MP3 decoding for streamed playback.
+ *
+ * Copyright (c) 2018-2019 John Davis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "AudioDxeCfg.h"
+
+#define MP3_HEADER_SIZE       (4)
+#define MP3_ID3_HEADER_SIZE   (10)
+
+// Bitrates in kbps, indexed by [table][bitrate index].
+STATIC CONST UINT16 mMp3Bitrates[5][15] = {
+  { 0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448 },  // MPEG-1 Layer I
+  { 0, 32, 48, 56,  64,  80,  96, 112, 128, 160, 192, 224, 256, 320, 384 },  // MPEG-1 Layer II
+  { 0, 32, 40, 48,  56,  64,  80,  96, 112, 128, 160, 192, 224, 256, 320 },  // MPEG-1 Layer III
+  { 0, 32, 48, 56,  64,  80,  96, 112, 128, 144, 160, 176, 192, 224, 256 },  // MPEG-2/2.5 Layer I
+  { 0,  8, 16, 24,  32,  40,  48,  56,  64,  80,  96, 112, 128, 144, 160 }   // MPEG-2/2.5 Layer II & III
+};
+
+// Sample rates in Hz, indexed by [version][sample rate index].
+STATIC CONST UINT32 mMp3SampleRates[4][3] = {
+  { 11025, 12000,  8000 },  // MPEG-2.5
+  {     0,     0,     0 },  // Reserved
+  { 22050, 24000, 16000 },  // MPEG-2
+  { 44100, 48000, 32000 }   // MPEG-1
+};
+
+/**
+  Parse the MPEG audio frame header at Data.
+
+  @param[in]  Data              Frame header, at least MP3_HEADER_SIZE bytes.
+  @param[out] FrameLength       Length of the whole frame in bytes.
+  @param[out] SamplesPerFrame   Samples per channel in this frame.
+  @param[out] Channels          Channel count of this frame.
+
+  @retval TRUE if the header is valid.
+**/
+STATIC
+BOOLEAN
+Mp3ParseHeader (
+  IN  CONST UINT8   *Data,
+  OUT UINT32        *FrameLength,
+  OUT UINT32        *SamplesPerFrame,
+  OUT UINT8         *Channels
+  )
+{
+  UINT8     Version;
+  UINT8     Layer;
+  UINT8     BitrateIndex;
+  UINT8     SampleRateIndex;
+  UINT8     Padding;
+  UINT32    Bitrate;
+  UINT32    SampleRate;
+
+  //
+
+  // Frame sync.
+  if ((Data[0] != 0xFF) || ((Data[1] & 0xE0) != 0xE0)) {
+    return FALSE;
+  }
+
+  Version         = (Data[1] >> 3) & 0x03;
+  Layer           = (Data[1] >> 1) & 0x03;
+  BitrateIndex    = (Data[2] >> 4) & 0x0F;
+  SampleRateIndex = (Data[2] >> 2) & 0x03;
+  Padding         = (Data[2] >> 1) & 0x01;
+
+  // Reject reserved values and free format streams.
+  if ((Version == 1) || (Layer == 0) || (BitrateIndex == 0) || (BitrateIndex == 15) || (SampleRateIndex == 3)) {
+    return FALSE;
+  }
+
+  SampleRate = mMp3SampleRates[Version][SampleRateIndex];
+
+  if (Version == 3) {
+    Bitrate = mMp3Bitrates[3 - Layer][BitrateIndex];
+  } else {
+    Bitrate = mMp3Bitrates[(Layer == 3) ? 3 : 4][BitrateIndex];
+  }
+  Bitrate *= 1000;
+
+  if (Layer == 3) {
+    // Layer I.
+    *SamplesPerFrame  = 384;
+    *FrameLength      = ((12 * Bitrate / SampleRate) + Padding) * 4;
+  } else {
+    // Layer II, and Layer III for MPEG-2/2.5 use half the samples.
+    *SamplesPerFrame  = ((Layer == 1) && (Version != 3)) ? 576 : 1152;
+    *FrameLength      = ((*SamplesPerFrame / 8) * Bitrate / SampleRate) + Padding;
+  }
+
+  *Channels = (((Data[3] >> 6) & 0x03) == 3) ? 1 : 2;
+
+  return TRUE;
+}
+
+/**
+  Decode a run of whole frames from the stream.
+
+  @param[in]  Stream        MP3 stream.
+  @param[in]  FirstFrame    Index of the first frame to decode.
+  @param[in]  LastFrame     Index one past the last frame to decode.
+  @param[out] Buffer        Decoded PCM, to be freed by the caller.
+  @param[out] BufferSize    Size of decoded PCM in bytes.
+**/
+STATIC
+EFI_STATUS
+Mp3DecodeFrames (
+  IN  MP3_STREAM    *Stream,
+  IN  UINTN         FirstFrame,
+  IN  UINTN         LastFrame,
+  OUT UINT8         **Buffer,
+  OUT UINT32        *BufferSize
+  )
+{
+  EFI_STATUS    Status;
+  UINT32        Offset;
+  UINT64        StartTicks;
+
+  //
+
+  StartTicks  = GetPerformanceCounter ();
+  Offset      = Stream->FrameOffsets[FirstFrame];
+
+  Status = Stream->AudioDecode->DecodeAny (
+    Stream->AudioDecode,
+    &Stream->Data[Offset],
+    Stream->FrameOffsets[LastFrame] - Offset,
+    (VOID **)Buffer,
+    BufferSize,
+    &Stream->Frequency,
+    &Stream->Bits,
+    &Stream->Channels
+    );
+
+  Stream->DecodeTicks   += GetPerformanceCounter () - StartTicks;
+  Stream->DecodedFrames += LastFrame - FirstFrame;
+
+  return Status;
+}
+
+/**
+  Decode the next chunk of frames from the stream.
+
+  @param[in]  Stream        MP3 stream.
+  @param[out] Buffer        Decoded PCM, to be freed by the caller.
+  @param[out] BufferSize    Size of decoded PCM in bytes.
+
+  @retval EFI_END_OF_FILE when all frames were decoded.
+**/
+STATIC
+EFI_STATUS
+Mp3StreamDecodeChunk (
+  IN  MP3_STREAM    *Stream,
+  OUT UINT8         **Buffer,
+  OUT UINT32        *BufferSize
+  )
+{
+  EFI_STATUS    Status;
+  UINTN         FirstFrame;
+  UINTN         LastFrame;
+  UINTN         PrimingFrames;
+  UINT8         *PrimingBuffer;
+  UINT32        PrimingSize;
+
+  //
+
+  if ((Stream == NULL) || (Stream->FrameOffsets == NULL) || (Buffer == NULL) || (BufferSize == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (Stream->NextFrame >= Stream->FrameCount) {
+    return EFI_END_OF_FILE;
+  }
+
+  FirstFrame    = Stream->NextFrame;
+  LastFrame     = MIN (FirstFrame + MP3_STREAM_CHUNK_FRAMES, Stream->FrameCount);
+  PrimingFrames = MIN (FirstFrame, MP3_STREAM_PRIMING_FRAMES);
+  PrimingSize   = 0;
+
+  //
+  // Frames may borrow bits from the reservoir of preceding frames and overlap
+  // with their output, so decode a few preceding frames along with the chunk
+  // and drop their output. The decoder is causal, thus the dropped amount
+  // equals the output of the priming frames decoded on their own.
+  //
+  if (PrimingFrames > 0) {
+    Status = Mp3DecodeFrames (Stream, FirstFrame - PrimingFrames, FirstFrame, &PrimingBuffer, &PrimingSize);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+    FreePool (PrimingBuffer);
+  }
+
+  Status = Mp3DecodeFrames (Stream, FirstFrame - PrimingFrames, LastFrame, Buffer, BufferSize);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if (PrimingSize > 0) {
+    if (*BufferSize <= PrimingSize) {
+      FreePool (*Buffer);
+      *Buffer = NULL;
+      return EFI_VOLUME_CORRUPTED;
+    }
+
+    *BufferSize -= PrimingSize;
+    CopyMem (*Buffer, *Buffer + PrimingSize, *BufferSize);
+  }
+
+  Stream->NextFrame = LastFrame;
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+Mp3StreamRead (
+  IN  AUDIO_SOURCE  *This,
+  OUT UINT8         *Buffer,
+  IN  UINTN         Length,
+  OUT UINTN         *ReadLength
+  )
+{
+  EFI_STATUS    Status;
+  MP3_STREAM    *Stream;
+  UINTN         CopyLength;
+
+  //
+
+  Stream      = BASE_CR (This, MP3_STREAM, Source);
+  *ReadLength = 0;
+
+  while (*ReadLength < Length) {
+    // Decode another chunk once the current one is consumed.
+    if (Stream->ChunkPosition >= Stream->ChunkSize) {
+      if (Stream->Chunk != NULL) {
+        FreePool (Stream->Chunk);
+        Stream->Chunk = NULL;
+      }
+
+      Stream->ChunkFrame    = Stream->NextFrame;
+      Stream->ChunkPosition = 0;
+      Stream->ChunkSize     = 0;
+
+      Status = Mp3StreamDecodeChunk (Stream, &Stream->Chunk, &Stream->ChunkSize);
+      if (EFI_ERROR (Status)) {
+        if ((Status == EFI_END_OF_FILE) && (*ReadLength > 0)) {
+          return EFI_SUCCESS;
+        }
+        return Status;
+      }
+    }
+
+    CopyLength = MIN (Length - *ReadLength, Stream->ChunkSize - Stream->ChunkPosition);
+    CopyMem (Buffer + *ReadLength, Stream->Chunk + Stream->ChunkPosition, CopyLength);
+    Stream->ChunkPosition += (UINT32)CopyLength;
+    *ReadLength           += CopyLength;
+  }
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+Mp3StreamRewind (
+  IN  AUDIO_SOURCE  *This
+  )
+{
+  MP3_STREAM    *Stream;
+
+  //
+
+  Stream = BASE_CR (This, MP3_STREAM, Source);
+
+  // The first chunk is kept around, it is decoded already when probing.
+  if ((Stream->Chunk != NULL) && (Stream->ChunkFrame == 0)) {
+    Stream->ChunkPosition = 0;
+    return EFI_SUCCESS;
+  }
+
+  if (Stream->Chunk != NULL) {
+    FreePool (Stream->Chunk);
+    Stream->Chunk = NULL;
+  }
+
+  Stream->NextFrame     = 0;
+  Stream->ChunkFrame    = 0;
+  Stream->ChunkSize     = 0;
+  Stream->ChunkPosition = 0;
+
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+Mp3StreamOpen (
+  OUT MP3_STREAM                  *Stream,
+  IN  EFI_AUDIO_DECODE_PROTOCOL   *AudioDecode,
+  IN  CONST UINT8                 *Data,
+  IN  UINTN                       DataLength
+  )
+{
+  EFI_STATUS    Status;
+  UINTN         Offset;
+  UINTN         FrameCount;
+  UINT32        FrameLength;
+  UINT32        SamplesPerFrame;
+  UINT8         Channels;
+  UINT32        *FrameOffsets;
+
+  //
+
+  if ((Stream == NULL) || (AudioDecode == NULL) || (Data == NULL) || (DataLength > MAX_UINT32)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  ZeroMem (Stream, sizeof (*Stream));
+
+  // Skip ID3v2 tag, its size is stored as a syncsafe integer.
+  Offset = 0;
+  if ((DataLength >= MP3_ID3_HEADER_SIZE) && (Data[0] == 'I') && (Data[1] == 'D') && (Data[2] == '3')) {
+    Offset = MP3_ID3_HEADER_SIZE
+      + (((UINTN)(Data[6] & 0x7F) << 21) | ((UINTN)(Data[7] & 0x7F) << 14) | ((UINTN)(Data[8] & 0x7F) << 7) | (Data[9] & 0x7F));
+    if ((Data[5] & BIT4) != 0) {
+      Offset += MP3_ID3_HEADER_SIZE;
+    }
+  }
+
+  // First pass counts frames, second pass records their offsets.
+  FrameOffsets  = NULL;
+  FrameCount    = 0;
+
+  while (TRUE) {
+    Stream->DataOffset = Offset;
+
+    while (((Offset + MP3_HEADER_SIZE) <= DataLength)
+      && Mp3ParseHeader (&Data[Offset], &FrameLength, &SamplesPerFrame, &Channels)
+      && ((Offset + FrameLength) <= DataLength)) {
+      if (FrameOffsets != NULL) {
+        FrameOffsets[FrameCount] = (UINT32)Offset;
+      }
+
+      // All frames are expected to share the first frame layout.
+      if (FrameCount == 0) {
+        Stream->SamplesPerFrame = SamplesPerFrame;
+        Stream->Channels        = Channels;
+      }
+
+      FrameCount++;
+      Offset += FrameLength;
+    }
+
+    if (FrameOffsets != NULL) {
+      FrameOffsets[FrameCount] = (UINT32)Offset;
+      break;
+    }
+
+    if (FrameCount == 0) {
+      return EFI_UNSUPPORTED;
+    }
+
+    FrameOffsets = AllocatePool ((FrameCount + 1) * sizeof (UINT32));
+    if (FrameOffsets == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    Offset      = Stream->DataOffset;
+    FrameCount  = 0;
+  }
+
+  Stream->AudioDecode   = AudioDecode;
+  Stream->Data          = Data;
+  Stream->DataLength    = DataLength;
+  Stream->FrameOffsets  = FrameOffsets;
+  Stream->FrameCount    = FrameCount;
+  Stream->NextFrame     = 0;
+
+  // Probe output format by decoding the first chunk, which is kept for playback.
+  Status = Mp3StreamDecodeChunk (Stream, &Stream->Chunk, &Stream->ChunkSize);
+  if (EFI_ERROR (Status)) {
+    Mp3StreamClose (Stream);
+    return Status;
+  }
+
+  Stream->Source.Read         = Mp3StreamRead;
+  Stream->Source.Rewind       = Mp3StreamRewind;
+  Stream->Source.Frequency    = Stream->Frequency;
+  Stream->Source.Bits         = Stream->Bits;
+  Stream->Source.Channels     = Stream->Channels;
+  Stream->Source.TotalSamples = FrameCount * Stream->SamplesPerFrame;
+
+  return EFI_SUCCESS;
+}
+
+VOID
+Mp3StreamClose (
+  IN  MP3_STREAM    *Stream
+  )
+{
+  if ((Stream != NULL) && (Stream->FrameOffsets != NULL)) {
+    if (Stream->Chunk != NULL) {
+      FreePool (Stream->Chunk);
+    }
+
+    FreePool (Stream->FrameOffsets);
+    ZeroMem (Stream, sizeof (*Stream));
+  }
+}
@@ -0,0 +1,392 @@
+/*
+ * File: Resample.c
+ *
+ * Description: Polyphase sample rate conversion.
+ *
+ * Copyright (c) 2018-2019 John Davis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "AudioDxeCfg.h"
+
+//
+// Rates are converted by an exact ratio L/M, output frame k sitting at input
+// time k * M / L. Each of the L fractional positions (phases) gets its own
+// row of Q30 coefficients, derived once from the prototype lowpass in
+// ResampleFilter.c, so the inner loop is a plain multiply-accumulate. When
+// downsampling, the prototype is stretched to cut off at the output Nyquist.
+//
+
+STATIC
+UINT32
+ResampleGcd (
+  IN  UINT32  A,
+  IN  UINT32  B
+  )
+{
+  UINT32  Remainder;
+
+  //
+
+  while (B != 0) {
+    Remainder = A % B;
+    A         = B;
+    B         = Remainder;
+  }
+
+  return A;
+}
+
+/**
+  Build the coefficient row of each phase, normalized to unity gain.
+**/
+STATIC
+EFI_STATUS
+ResampleBuildPhases (
+  IN OUT RESAMPLE_SOURCE  *Source
+  )
+{
+  INT32     *Row;
+  UINT32    Stretch;
+  INTN      Distance;
+  UINTN     Position;
+  UINTN     Index;
+  INT32     Remainder;
+  INT64     Sum;
+  INT64     Value;
+  INT32     *Coefs;
+  INT64     Quantized;
+  UINTN     Peak;
+  UINT32    p;
+  UINTN     j;
+
+  //
+
+  Row = AllocatePool (Source->Taps * sizeof (INT32));
+  if (Row == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Stretch = MAX (Source->L, Source->M);
+
+  for (p = 0; p < Source->L; p++) {
+    Sum = 0;
+    for (j = 0; j < Source->Taps; j++) {
+      // Distance to the tap in table units, interpolated between entries.
+      Distance  = (INTN)p + ((INTN)(Source->Taps / 2) - 1 - (INTN)j) * (INTN)Source->L;
+      Position  = (UINTN)((Distance < 0) ? -Distance : Distance) * RESAMPLE_FILTER_RESOLUTION;
+      Index     = Position / Stretch;
+      Remainder = (INT32)(Position % Stretch);
+
+      if (Index >= (RESAMPLE_FILTER_LENGTH - 1)) {
+        Row[j] = 0;
+      } else {
+        Row[j] = mResampleFilter[Index] + ((mResampleFilter[Index + 1] - mResampleFilter[Index]) * Remainder) / (INT32)Stretch;
+      }
+      Sum += Row[j];
+    }
+
+    // Quantize, then put the rounding residual on the largest tap so the row sums to one exactly.
+    Coefs     = &Source->Coefs[p * Source->Taps];
+    Quantized = 0;
+    Peak      = 0;
+    for (j = 0; j < Source->Taps; j++) {
+      Value = MultS64x64 (Row[j], RESAMPLE_COEF_ONE);
+      if (Value < 0) {
+        Coefs[j] = (INT32)-DivS64x64Remainder (DivS64x64Remainder (Sum, 2, NULL) - Value, Sum, NULL);
+      } else {
+        Coefs[j] = (INT32)DivS64x64Remainder (Value + DivS64x64Remainder (Sum, 2, NULL), Sum, NULL);
+      }
+
+      Quantized += Coefs[j];
+      if (Coefs[j] > Coefs[Peak]) {
+        Peak = j;
+      }
+    }
+
+    Coefs[Peak] = (INT32)(Coefs[Peak] + RESAMPLE_COEF_ONE - Quantized);
+  }
+
+  FreePool (Row);
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Move unused frames to the start of the window and read more input. Once
+  the input ends, the window is padded with silence to flush the filter.
+**/
+STATIC
+EFI_STATUS
+ResampleFill (
+  IN OUT RESAMPLE_SOURCE  *Source
+  )
+{
+  EFI_STATUS    Status;
+  UINT8         Channels;
+  UINTN         BytesPerSample;
+  UINTN         Frames;
+  UINTN         ReadLength;
+  UINTN         i;
+
+  //
+
+  Channels        = Source->Inner->Channels;
+  BytesPerSample  = AudioIoBytesPerSample (Source->Inner->Bits);
+
+  CopyMem (
+    Source->Window,
+    &Source->Window[Source->Base * Channels],
+    (Source->WindowCount - Source->Base) * Channels * sizeof (INT32)
+    );
+  Source->WindowCount -= Source->Base;
+  Source->Base         = 0;
+
+  while (!Source->InnerDone && (Source->WindowCount < Source->WindowSize)) {
+    Frames = MIN (Source->WindowSize - Source->WindowCount, RESAMPLE_BLOCK_FRAMES);
+    Status = Source->Inner->Read (Source->Inner, Source->Scratch, Frames * Channels * BytesPerSample, &ReadLength);
+    if (EFI_ERROR (Status) && (Status != EFI_END_OF_FILE)) {
+      return Status;
+    }
+
+    Frames = ReadLength / (Channels * BytesPerSample);
+    for (i = 0; i < Frames * Channels; i++) {
+      Source->Window[Source->WindowCount * Channels + i] = ConvertLoadSample (&Source->Scratch[i * BytesPerSample], Source->Inner->Bits);
+    }
+    Source->WindowCount += Frames;
+    Source->InputFrames += Frames;
+
+    if ((Status == EFI_END_OF_FILE) || (Frames == 0)) {
+      Source->InnerDone = TRUE;
+    }
+  }
+
+  if (Source->InnerDone && !Source->Flushed && ((Source->WindowSize - Source->WindowCount) >= (Source->Taps / 2))) {
+    ZeroMem (&Source->Window[Source->WindowCount * Channels], (Source->Taps / 2) * Channels * sizeof (INT32));
+    Source->WindowCount += Source->Taps / 2;
+    Source->Flushed      = TRUE;
+  }
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+ResampleSourceRead (
+  IN  AUDIO_SOURCE  *This,
+  OUT UINT8         *Buffer,
+  IN  UINTN         Length,
+  OUT UINTN         *ReadLength
+  )
+{
+  EFI_STATUS        Status;
+  RESAMPLE_SOURCE   *Source;
+  UINT8             Channels;
+  UINTN             BytesPerSample;
+  UINTN             Frames;
+  UINTN             MaxFrames;
+  CONST INT32       *Coefs;
+  CONST INT32       *Window;
+  INT64             Acc;
+  INT64             Round;
+  UINT64            StartTicks;
+  UINTN             j;
+  UINT8             c;
+
+  //
+
+  Source          = BASE_CR (This, RESAMPLE_SOURCE, Source);
+  Channels        = This->Channels;
+  BytesPerSample  = AudioIoBytesPerSample (This->Bits);
+  MaxFrames       = Length / (Channels * BytesPerSample);
+  StartTicks      = GetPerformanceCounter ();
+
+  // Round to the output width, stores truncate.
+  Round = LShiftU64 (1, RESAMPLE_COEF_SHIFT - 1 + 32 - AudioIoBitsToWidth (This->Bits));
+
+  for (Frames = 0; Frames < MaxFrames; Frames++) {
+    if ((Source->Base + Source->Taps) > Source->WindowCount) {
+      Status = ResampleFill (Source);
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+
+      if ((Source->Base + Source->Taps) > Source->WindowCount) {
+        break;
+      }
+    }
+
+    // Stop at the end of the input.
+    if (Source->InnerDone && (Source->Center >= Source->InputFrames)) {
+      break;
+    }
+
+    Coefs = &Source->Coefs[Source->Phase * Source->Taps];
+    for (c = 0; c < Channels; c++) {
+      Window  = &Source->Window[Source->Base * Channels + c];
+      Acc     = Round;
+      for (j = 0; (j + 4) <= Source->Taps; j += 4) {
+        Acc += (INT64)Window[j * Channels]       * Coefs[j];
+        Acc += (INT64)Window[(j + 1) * Channels] * Coefs[j + 1];
+        Acc += (INT64)Window[(j + 2) * Channels] * Coefs[j + 2];
+        Acc += (INT64)Window[(j + 3) * Channels] * Coefs[j + 3];
+      }
+
+      Acc = (INT64)ARShiftU64 ((UINT64)Acc, RESAMPLE_COEF_SHIFT);
+      if (Acc > MAX_INT32) {
+        Acc = MAX_INT32;
+      } else if (Acc < MIN_INT32) {
+        Acc = MIN_INT32;
+      }
+
+      ConvertStoreSample (Buffer, This->Bits, (INT32)Acc);
+      Buffer += BytesPerSample;
+    }
+
+    // Next output position.
+    Source->Phase  += Source->M;
+    Source->Base   += Source->Phase / Source->L;
+    Source->Center += Source->Phase / Source->L;
+    Source->Phase  %= Source->L;
+  }
+
+  Source->Ticks   += GetPerformanceCounter () - StartTicks;
+  Source->Frames  += Frames;
+
+  *ReadLength = Frames * Channels * BytesPerSample;
+
+  return (Frames > 0) ? EFI_SUCCESS : EFI_END_OF_FILE;
+}
+
+STATIC
+VOID
+ResampleReset (
+  IN OUT RESAMPLE_SOURCE  *Source
+  )
+{
+  // Silence before the first frame, so it sits at the filter center.
+  ZeroMem (Source->Window, (Source->Taps / 2 - 1) * Source->Inner->Channels * sizeof (INT32));
+  Source->WindowCount = Source->Taps / 2 - 1;
+  Source->Base        = 0;
+  Source->Phase       = 0;
+  Source->Center      = 0;
+  Source->InputFrames = 0;
+  Source->InnerDone   = FALSE;
+  Source->Flushed     = FALSE;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+ResampleSourceRewind (
+  IN  AUDIO_SOURCE  *This
+  )
+{
+  RESAMPLE_SOURCE   *Source;
+
+  //
+
+  Source = BASE_CR (This, RESAMPLE_SOURCE, Source);
+  ResampleReset (Source);
+
+  return Source->Inner->Rewind (Source->Inner);
+}
+
+EFI_STATUS
+ResampleSourceInit (
+  OUT RESAMPLE_SOURCE             *Source,
+  IN  AUDIO_SOURCE                *Inner,
+  IN  EFI_AUDIO_IO_PROTOCOL_FREQ  Frequency
+  )
+{
+  EFI_STATUS    Status;
+  UINT32        InHz;
+  UINT32        OutHz;
+  UINT32        Gcd;
+
+  //
+
+  ZeroMem (Source, sizeof (*Source));
+
+  InHz  = AudioIoFreqToHz (Inner->Frequency);
+  OutHz = AudioIoFreqToHz (Frequency);
+  if ((InHz == 0) || (OutHz == 0) || (Inner->Channels == 0)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  Gcd       = ResampleGcd (InHz, OutHz);
+  Source->L = OutHz / Gcd;
+  Source->M = InHz / Gcd;
+
+  // Enough taps to span all zero crossings of the, possibly stretched, filter,
+  // in multiples of the inner loop unrolling.
+  Source->Taps = ALIGN_VALUE (2 * ((RESAMPLE_ZERO_CROSSINGS * MAX (Source->L, Source->M) + Source->L - 1) / Source->L), 4);
+  if (Source->Taps > RESAMPLE_MAX_TAPS) {
+    return EFI_UNSUPPORTED;
+  }
+
+  CopyMem (&Source->Source, Inner, sizeof (Source->Source));
+  Source->Source.Read         = ResampleSourceRead;
+  Source->Source.Rewind       = ResampleSourceRewind;
+  Source->Source.Frequency    = Frequency;
+  Source->Source.TotalSamples = (UINTN)DivU64x32 (MultU64x32 (Inner->TotalSamples, Source->L) + Source->M - 1, Source->M);
+  Source->Inner               = Inner;
+  Source->WindowSize          = Source->Taps + RESAMPLE_BLOCK_FRAMES;
+
+  Source->Coefs   = AllocatePool (Source->L * Source->Taps * sizeof (INT32));
+  Source->Window  = AllocatePool (Source->WindowSize * Inner->Channels * sizeof (INT32));
+  Source->Scratch = AllocatePool (RESAMPLE_BLOCK_FRAMES * Inner->Channels * AudioIoBytesPerSample (Inner->Bits));
+  if ((Source->Coefs == NULL) || (Source->Window == NULL) || (Source->Scratch == NULL)) {
+    ResampleSourceFree (Source);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Status = ResampleBuildPhases (Source);
+  if (EFI_ERROR (Status)) {
+    ResampleSourceFree (Source);
+    return Status;
+  }
+
+  ResampleReset (Source);
+
+  return EFI_SUCCESS;
+}
+
+VOID
+ResampleSourceFree (
+  IN  RESAMPLE_SOURCE   *Source
+  )
+{
+  if (Source->Coefs != NULL) {
+    FreePool (Source->Coefs);
+    Source->Coefs = NULL;
+  }
+
+  if (Source->Window != NULL) {
+    FreePool (Source->Window);
+    Source->Window = NULL;
+  }
+
+  if (Source->Scratch != NULL) {
+    FreePool (Source->Scratch);
+    Source->Scratch = NULL;
+  }
+}
@@ -0,0 +1,424 @@
+/*
+ * File: ResampleFilter.c
+ *
+ * Description: Resampler prototype lowpass, Kaiser windowed sinc,
+ * cutoff 0.91 of Nyquist, beta 9.0.
+ *
+ * Generated by Tools/FilterGen.py, do not edit.
+ *
+ */
+
+#include "AudioDxeCfg.h"
+
+CONST INT32 mResampleFilter[RESAMPLE_FILTER_LENGTH] = {
+  15267267, 15265993, 15262174, 15255810, 15246904, 15235457, 15221473, 15204957, 15185914, 15164348,
+  15140268, 15113679, 15084590, 15053010, 15018948, 14982415, 14943421, 14901978, 14858099, 14811797,
+  14763085, 14711979, 14658493, 14602645, 14544450, 14483925, 14421090, 14355963, 14288563, 14218911,
+  14147027, 14072933, 13996650, 13918203, 13837614, 13754907, 13670106, 13583238, 13494328, 13403402,
+  13310487, 13215611, 13118802, 13020088, 12919499, 12817065, 12712816, 12606782, 12498995, 12389487,
+  12278289, 12165435, 12050957, 11934889, 11817266, 11698120, 11577488, 11455405, 11331905, 11207026,
+  11080802, 10953271, 10824470, 10694436, 10563207, 10430820, 10297313, 10162725, 10027095, 9890461,
+  9752862, 9614338, 9474928, 9334672, 9193609, 9051780, 8909224, 8765983, 8622095, 8477602,
+  8332544, 8186962, 8040896, 7894387, 7747476, 7600203, 7452609, 7304735, 7156621, 7008308,
+  6859836, 6711247, 6562579, 6413875, 6265173, 6116514, 5967937, 5819484, 5671192, 5523102,
+  5375252, 5227682, 5080431, 4933536, 4787037, 4640971, 4495377, 4350291, 4205751, 4061793,
+  3918455, 3775772, 3633781, 3492517, 3352015, 3212310, 3073436, 2935428, 2798319, 2662142,
+  2526929, 2392714, 2259529, 2127403, 1996370, 1866458, 1737698, 1610119, 1483750, 1358621,
+  1234758, 1112188, 990940, 871039, 752511, 635381, 519674, 405414, 292623, 181326,
+  71544, -36701, -143388, -248496, -352006, -453899, -554155, -652758, -749689, -844932,
+  -938472, -1030292, -1120377, -1208715, -1295291, -1380093, -1463109, -1544326, -1623736, -1701326,
+  -1777088, -1851014, -1923095, -1993323, -2061692, -2128196, -2192830, -2255588, -2316467, -2375463,
+  -2432574, -2487797, -2541131, -2592575, -2642130, -2689795, -2735572, -2779463, -2821470, -2861597,
+  -2899847, -2936224, -2970735, -3003383, -3034177, -3063122, -3090226, -3115497, -3138945, -3160578,
+  -3180406, -3198440, -3214691, -3229170, -3241890, -3252863, -3262103, -3269624, -3275440, -3279566,
+  -3282017, -3282809, -3281960, -3279484, -3275401, -3269728, -3262483, -3253686, -3243355, -3231510,
+  -3218171, -3203359, -3187095, -3169400, -3150296, -3129805, -3107949, -3084752, -3060237, -3034426,
+  -3007345, -2979018, -2949468, -2918720, -2886801, -2853734, -2819546, -2784263, -2747910, -2710515,
+  -2672103, -2632701, -2592337, -2551037, -2508829, -2465740, -2421799, -2377032, -2331468, -2285134,
+  -2238059, -2190271, -2141799, -2092669, -2042912, -1992556, -1941628, -1890158, -1838174, -1785705,
+  -1732778, -1679424, -1625669, -1571543, -1517073, -1462289, -1407218, -1351888, -1296328, -1240565,
+  -1184628, -1128543, -1072339, -1016042, -959681, -903282, -846871, -790476, -734123, -677838,
+  -621648, -565577, -509652, -453899, -398341, -343004, -287912, -233090, -178562, -124350,
+  -70479, -16972, 36150, 88862, 141145, 192975, 244332, 295194, 345541, 395352,
+  444609, 493291, 541380, 588856, 635701, 681898, 727430, 772278, 816427, 859860,
+  902562, 944517, 985711, 1026128, 1065756, 1104581, 1142589, 1179767, 1216105, 1251590,
+  1286210, 1319956, 1352816, 1384782, 1415843, 1445991, 1475218, 1503515, 1530876, 1557292,
+  1582759, 1607269, 1630817, 1653399, 1675009, 1695644, 1715300, 1733973, 1751662, 1768363,
+  1784076, 1798799, 1812531, 1825271, 1837021, 1847781, 1857551, 1866333, 1874129, 1880942,
+  1886774, 1891629, 1895510, 1898422, 1900368, 1901355, 1901387, 1900471, 1898612, 1895817,
+  1892094, 1887449, 1881890, 1875426, 1868066, 1859817, 1850690, 1840694, 1829840, 1818136,
+  1805595, 1792228, 1778044, 1763057, 1747279, 1730720, 1713395, 1695316, 1676496, 1656948,
+  1636687, 1615726, 1594079, 1571761, 1548786, 1525170, 1500928, 1476074, 1450625, 1424597,
+  1398004, 1370863, 1343191, 1315004, 1286319, 1257151, 1227519, 1197439, 1166929, 1136005,
+  1104685, 1072986, 1040925, 1008522, 975792, 942754, 909426, 875825, 841970, 807877,
+  773566, 739054, 704358, 669497, 634489, 599352, 564103, 528760, 493340, 457863,
+  422345, 386803, 351256, 315720, 280214, 244753, 209356, 174039, 138818, 103712,
+  68736, 33906, -760, -35247, -69540, -103621, -137476, -171090, -204446, -237531,
+  -270328, -302824, -335005, -366855, -398362, -429511, -460290, -490684, -520680, -550267,
+  -579432, -608162, -636446, -664272, -691628, -718504, -744889, -770772, -796142, -820991,
+  -845309, -869085, -892312, -914980, -937081, -958606, -979549, -999902, -1019657, -1038808,
+  -1057349, -1075272, -1092573, -1109245, -1125284, -1140684, -1155442, -1169553, -1183013, -1195819,
+  -1207967, -1219454, -1230279, -1240439, -1249931, -1258755, -1266910, -1274393, -1281206, -1287347,
+  -1292817, -1297616, -1301744, -1305204, -1307997, -1310123, -1311585, -1312386, -1312528, -1312014,
+  -1310848, -1309032, -1306571, -1303468, -1299729, -1295359, -1290361, -1284741, -1278506, -1271660,
+  -1264210, -1256163, -1247524, -1238302, -1228502, -1218133, -1207202, -1195717, -1183685, -1171117,
+  -1158019, -1144401, -1130272, -1115642, -1100518, -1084912, -1068833, -1052290, -1035295, -1017857,
+  -999987, -981696, -962994, -943893, -924404, -904538, -884306, -863720, -842792, -821533,
+  -799956, -778072, -755894, -733433, -710703, -687714, -664481, -641015, -617329, -593436,
+  -569348, -545077, -520638, -496042, -471302, -446431, -421442, -396348, -371162, -345896,
+  -320563, -295177, -269749, -244292, -218820, -193345, -167879, -142435, -117025, -91663,
+  -66359, -41128, -15979, 9073, 34018, 58843, 83537, 108088, 132484, 156714,
+  180767, 204632, 228297, 251751, 274985, 297986, 320746, 343253, 365498, 387470,
+  409160, 430558, 451655, 472442, 492909, 513048, 532849, 552306, 571408, 590149,
+  608521, 626515, 644125, 661343, 678163, 694577, 710579, 726163, 741322, 756052,
+  770346, 784198, 797605, 810560, 823060, 835100, 846675, 857782, 868417, 878578,
+  888259, 897459, 906176, 914405, 922146, 929397, 936155, 942419, 948188, 953462,
+  958239, 962519, 966301, 969587, 972375, 974667, 976463, 977765, 978574, 978890,
+  978716, 978054, 976907, 975275, 973162, 970572, 967506, 963969, 959963, 955494,
+  950563, 945177, 939339, 933053, 926325, 919159, 911562, 903537, 895091, 886230,
+  876959, 867284, 857213, 846751, 835904, 824681, 813087, 801130, 788817, 776156,
+  763154, 749819, 736159, 722181, 707894, 693306, 678425, 663260, 647820, 632113,
+  616147, 599932, 583477, 566791, 549882, 532760, 515435, 497915, 480211, 462331,
+  444285, 426082, 407733, 389246, 370632, 351900, 333060, 314122, 295095, 275990,
+  256815, 237581, 218297, 198974, 179621, 160247, 140863, 121477, 102101, 82742,
+  63412, 44119, 24872, 5682, -13443, -32493, -51460, -70333, -89104, -107764,
+  -126304, -144715, -162989, -181117, -199091, -216901, -234541, -252001, -269273, -286351,
+  -303225, -319889, -336335, -352554, -368541, -384288, -399787, -415033, -430018, -444736,
+  -459181, -473345, -487224, -500812, -514101, -527088, -539766, -552131, -564177, -575899,
+  -587293, -598355, -609079, -619461, -629499, -639187, -648522, -657502, -666122, -674379,
+  -682271, -689795, -696949, -703730, -710136, -716165, -721816, -727087, -731977, -736484,
+  -740607, -744347, -747702, -750672, -753257, -755456, -757271, -758701, -759747, -760410,
+  -760690, -760590, -760110, -759252, -758017, -756408, -754426, -752073, -749353, -746268,
+  -742820, -739012, -734848, -730331, -725464, -720250, -714695, -708800, -702572, -696013,
+  -689128, -681922, -674399, -666564, -658422, -649978, -641237, -632206, -622888, -613290,
+  -603417, -593276, -582871, -572210, -561299, -550142, -538748, -527123, -515272, -503203,
+  -490922, -478437, -465753, -452879, -439821, -426586, -413181, -399614, -385891, -372021,
+  -358010, -343867, -329598, -315211, -300713, -286113, -271417, -256634, -241771, -226836,
+  -211836, -196778, -181672, -166524, -151342, -136134, -120908, -105670, -90429, -75192,
+  -59968, -44762, -29584, -14439, 663, 15716, 30713, 45645, 60507, 75291,
+  89989, 104595, 119101, 133501, 147788, 161955, 175996, 189904, 203672, 217294,
+  230763, 244074, 257221, 270197, 282996, 295612, 308041, 320276, 332311, 344142,
+  355764, 367170, 378357, 389318, 400050, 410548, 420808, 430824, 440593, 450111,
+  459374, 468378, 477119, 485593, 493799, 501731, 509387, 516765, 523861, 530672,
+  537197, 543433, 549377, 555028, 560384, 565442, 570202, 574663, 578821, 582678,
+  586231, 589480, 592423, 595062, 597395, 599422, 601143, 602558, 603667, 604471,
+  604971, 605167, 605059, 604649, 603939, 602929, 601620, 600015, 598115, 595922,
+  593439, 590666, 587606, 584263, 580638, 576733, 572553, 568100, 563376, 558386,
+  553132, 547618, 541847, 535823, 529550, 523032, 516273, 509277, 502048, 494590,
+  486908, 479007, 470890, 462564, 454032, 445299, 436371, 427252, 417948, 408463,
+  398804, 388975, 378982, 368831, 358526, 348074, 337480, 326750, 315890, 304905,
+  293802, 282586, 271263, 259839, 248321, 236714, 225024, 213257, 201420, 189519,
+  177559, 165547, 153490, 141392, 129261, 117103, 104923, 92727, 80523, 68316,
+  56112, 43917, 31738, 19580, 7449, -4649, -16707, -28720, -40682, -52588,
+  -64431, -76205, -87906, -99527, -111063, -122508, -133858, -145105, -156247, -167276,
+  -178188, -188978, -199641, -210171, -220564, -230816, -240921, -250876, -260674, -270313,
+  -279787, -289093, -298226, -307182, -315957, -324549, -332951, -341162, -349178, -356995,
+  -364610, -372019, -379220, -386210, -392986, -399545, -405884, -412001, -417894, -423560,
+  -428997, -434204, -439177, -443916, -448419, -452684, -456711, -460496, -464040, -467341,
+  -470399, -473213, -475781, -478104, -480181, -482011, -483595, -484933, -486024, -486868,
+  -487467, -487820, -487929, -487793, -487413, -486791, -485928, -484824, -483481, -481900,
+  -480083, -478032, -475747, -473232, -470487, -467516, -464319, -460900, -457261, -453404,
+  -449332, -445047, -440553, -435851, -430946, -425840, -420536, -415038, -409348, -403471,
+  -397410, -391168, -384749, -378156, -371395, -364467, -357378, -350132, -342732, -335182,
+  -327487, -319652, -311680, -303576, -295344, -286988, -278514, -269926, -261229, -252427,
+  -243524, -234526, -225438, -216264, -207009, -197678, -188275, -178807, -169277, -159690,
+  -150053, -140368, -130642, -120880, -111086, -101265, -91423, -81564, -71694, -61817,
+  -51938, -42063, -32196, -22341, -12505, -2691, 7095, 16848, 26564, 36238,
+  45866, 55442, 64962, 74422, 83817, 93142, 102392, 111565, 120654, 129657,
+  138568, 147383, 156099, 164711, 173215, 181608, 189885, 198043, 206077, 213985,
+  221763, 229407, 236914, 244280, 251502, 258577, 265503, 272275, 278891, 285348,
+  291643, 297774, 303738, 309533, 315156, 320604, 325877, 330971, 335884, 340615,
+  345162, 349523, 353696, 357680, 361474, 365075, 368484, 371698, 374717, 377540,
+  380165, 382593, 384822, 386853, 388684, 390315, 391746, 392977, 394008, 394839,
+  395470, 395901, 396133, 396166, 396001, 395639, 395080, 394324, 393374, 392230,
+  390893, 389364, 387646, 385738, 383643, 381362, 378897, 376250, 373423, 370417,
+  367234, 363878, 360349, 356650, 352784, 348752, 344558, 340204, 335692, 331026,
+  326207, 321240, 316127, 310870, 305473, 299940, 294272, 288474, 282548, 276499,
+  270329, 264042, 257641, 251129, 244512, 237791, 230971, 224056, 217048, 209953,
+  202773, 195512, 188176, 180766, 173288, 165745, 158141, 150480, 142766, 135003,
+  127196, 119347, 111462, 103544, 95598, 87626, 79635, 71626, 63606, 55576,
+  47543, 39509, 31479, 23456, 15446, 7450, -525, -8477, -16402, -24295,
+  -32153, -39972, -47749, -55478, -63158, -70783, -78351, -85857, -93299, -100672,
+  -107974, -115200, -122347, -129413, -136393, -143284, -150084, -156789, -163396, -169902,
+  -176303, -182598, -188784, -194857, -200814, -206654, -212374, -217970, -223441, -228785,
+  -233998, -239079, -244026, -248837, -253508, -258040, -262429, -266674, -270773, -274725,
+  -278528, -282180, -285681, -289028, -292222, -295259, -298140, -300864, -303429, -305835,
+  -308081, -310166, -312090, -313853, -315453, -316890, -318165, -319277, -320226, -321013,
+  -321636, -322096, -322394, -322530, -322505, -322318, -321970, -321462, -320795, -319969,
+  -318986, -317846, -316550, -315100, -313496, -311740, -309833, -307777, -305573, -303223,
+  -300727, -298089, -295309, -292389, -289332, -286139, -282812, -279353, -275765, -272049,
+  -268207, -264243, -260159, -255956, -251637, -247205, -242662, -238011, -233255, -228396,
+  -223436, -218380, -213229, -207986, -202654, -197237, -191737, -186157, -180500, -174770,
+  -168968, -163099, -157166, -151172, -145119, -139011, -132852, -126644, -120391, -114096,
+  -107762, -101393, -94992, -88562, -82107, -75629, -69132, -62620, -56095, -49562,
+  -43023, -36481, -29941, -23404, -16875, -10357, -3852, 2635, 9103, 15546,
+  21963, 28351, 34705, 41023, 47303, 53540, 59732, 65877, 71970, 78010,
+  83992, 89916, 95776, 101572, 107300, 112958, 118542, 124051, 129481, 134831,
+  140098, 145279, 150372, 155375, 160286, 165102, 169821, 174442, 178962, 183379,
+  187691, 191896, 195994, 199981, 203856, 207618, 211265, 214796, 218209, 221502,
+  224676, 227727, 230655, 233460, 236139, 238693, 241119, 243418, 245588, 247629,
+  249540, 251320, 252969, 254487, 255874, 257128, 258249, 259239, 260095, 260819,
+  261410, 261869, 262195, 262390, 262452, 262383, 262182, 261851, 261390, 260800,
+  260081, 259233, 258259, 257158, 255932, 254581, 253107, 251510, 249793, 247955,
+  245999, 243925, 241736, 239432, 237015, 234486, 231848, 229101, 226248, 223290,
+  220229, 217067, 213805, 210446, 206992, 203444, 199805, 196077, 192262, 188361,
+  184378, 180315, 176173, 171955, 167664, 163301, 158870, 154372, 149811, 145188,
+  140505, 135767, 130974, 126130, 121238, 116299, 111316, 106293, 101231, 96134,
+  91003, 85843, 80654, 75441, 70205, 64950, 59677, 54391, 49093, 43786,
+  38473, 33156, 27839, 22523, 17212, 11908, 6614, 1333, -3934, -9183,
+  -14412, -19618, -24799, -29952, -35075, -40165, -45219, -50236, -55213, -60148,
+  -65038, -69880, -74674, -79415, -84103, -88735, -93308, -97821, -102272, -106658,
+  -110978, -115230, -119411, -123520, -127555, -131514, -135395, -139197, -142918, -146556,
+  -150110, -153579, -156960, -160252, -163455, -166566, -169584, -172509, -175338, -178071,
+  -180707, -183245, -185683, -188021, -190258, -192393, -194425, -196354, -198179, -199899,
+  -201514, -203023, -204426, -205723, -206912, -207995, -208970, -209838, -210598, -211250,
+  -211795, -212232, -212561, -212783, -212898, -212906, -212808, -212603, -212292, -211876,
+  -211355, -210730, -210001, -209170, -208236, -207201, -206065, -204829, -203495, -202062,
+  -200533, -198908, -197189, -195375, -193470, -191473, -189387, -187212, -184950, -182602,
+  -180169, -177654, -175058, -172382, -169627, -166796, -163890, -160911, -157860, -154739,
+  -151550, -148295, -144976, -141594, -138151, -134650, -131091, -127478, -123812, -120095,
+  -116330, -112517, -108660, -104759, -100819, -96839, -92824, -88774, -84691, -80579,
+  -76439, -72273, -68084, -63873, -59643, -55396, -51134, -46859, -42574, -38281,
+  -33982, -29678, -25373, -21068, -16766, -12468, -8178, -3896, 375, 4633,
+  8875, 13100, 17305, 21489, 25650, 29785, 33892, 37970, 42017, 46030,
+  50008, 53949, 57851, 61711, 65530, 69303, 73031, 76710, 80340, 83919,
+  87444, 90915, 94330, 97688, 100986, 104223, 107398, 110510, 113557, 116538,
+  119451, 122296, 125070, 127774, 130405, 132963, 135446, 137854, 140186, 142440,
+  144616, 146713, 148730, 150666, 152521, 154294, 155984, 157591, 159114, 160553,
+  161907, 163175, 164358, 165455, 166466, 167390, 168228, 168979, 169643, 170219,
+  170709, 171112, 171428, 171657, 171800, 171856, 171825, 171709, 171507, 171220,
+  170848, 170392, 169852, 169228, 168521, 167733, 166862, 165911, 164880, 163769,
+  162580, 161313, 159969, 158549, 157054, 155486, 153844, 152130, 150345, 148491,
+  146568, 144577, 142521, 140399, 138214, 135966, 133657, 131288, 128861, 126377,
+  123837, 121243, 118597, 115899, 113152, 110357, 107515, 104628, 101698, 98725,
+  95713, 92662, 89574, 86451, 83295, 80107, 76888, 73641, 70367, 67068,
+  63746, 60403, 57039, 53658, 50260, 46848, 43423, 39987, 36541, 33088,
+  29630, 26167, 22702, 19237, 15772, 12311, 8855, 5405, 1963, -1470,
+  -4890, -8298, -11690, -15066, -18424, -21762, -25079, -28373, -31642, -34885,
+  -38100, -41287, -44442, -47565, -50655, -53709, -56727, -59707, -62648, -65547,
+  -68405, -71220, -73990, -76715, -79392, -82021, -84601, -87130, -89607, -92032,
+  -94403, -96719, -98979, -101183, -103329, -105416, -107444, -109412, -111319, -113164,
+  -114946, -116665, -118320, -119911, -121436, -122896, -124290, -125617, -126877, -128069,
+  -129193, -130249, -131236, -132155, -133004, -133784, -134495, -135135, -135707, -136208,
+  -136639, -137001, -137293, -137515, -137667, -137750, -137764, -137709, -137585, -137392,
+  -137131, -136802, -136406, -135943, -135413, -134817, -134155, -133428, -132637, -131782,
+  -130863, -129882, -128839, -127734, -126570, -125345, -124062, -122721, -121322, -119867,
+  -118357, -116792, -115174, -113504, -111782, -110009, -108187, -106317, -104399, -102435,
+  -100427, -98374, -96279, -94142, -91965, -89749, -87495, -85205, -82879, -80520,
+  -78127, -75703, -73249, -70767, -68257, -65721, -63160, -60575, -57969, -55342,
+  -52696, -50032, -47352, -44657, -41948, -39227, -36495, -33753, -31004, -28248,
+  -25487, -22722, -19954, -17186, -14418, -11652, -8889, -6130, -3378, -632,
+  2104, 4831, 7546, 10249, 12938, 15611, 18268, 20907, 23527, 26127,
+  28705, 31260, 33791, 36297, 38776, 41228, 43652, 46045, 48408, 50738,
+  53036, 55299, 57527, 59719, 61874, 63991, 66069, 68107, 70104, 72059,
+  73972, 75841, 77667, 79447, 81181, 82870, 84511, 86104, 87649, 89145,
+  90591, 91987, 93333, 94627, 95869, 97060, 98197, 99282, 100313, 101291,
+  102215, 103084, 103899, 104659, 105364, 106014, 106609, 107148, 107632, 108060,
+  108433, 108750, 109011, 109217, 109367, 109463, 109502, 109487, 109418, 109293,
+  109114, 108881, 108594, 108254, 107861, 107415, 106916, 106366, 105764, 105111,
+  104407, 103654, 102851, 101999, 101099, 100152, 99157, 98116, 97029, 95897,
+  94721, 93501, 92239, 90935, 89589, 88203, 86777, 85313, 83811, 82272,
+  80696, 79086, 77441, 75764, 74053, 72312, 70540, 68738, 66909, 65051,
+  63168, 61259, 59326, 57370, 55391, 53391, 51372, 49333, 47277, 45204,
+  43115, 41012, 38895, 36766, 34626, 32475, 30316, 28148, 25974, 23795,
+  21610, 19423, 17233, 15042, 12850, 10660, 8472, 6287, 4106, 1931,
+  -238, -2399, -4552, -6695, -8828, -10949, -13057, -15151, -17231, -19295,
+  -21342, -23371, -25382, -27373, -29344, -31293, -33220, -35124, -37003, -38858,
+  -40686, -42488, -44263, -46009, -47726, -49413, -51070, -52696, -54289, -55850,
+  -57377, -58870, -60329, -61752, -63140, -64491, -65805, -67081, -68320, -69520,
+  -70681, -71802, -72884, -73925, -74926, -75886, -76804, -77680, -78515, -79307,
+  -80057, -80764, -81428, -82049, -82627, -83161, -83652, -84098, -84502, -84861,
+  -85177, -85449, -85677, -85861, -86001, -86098, -86152, -86162, -86129, -86052,
+  -85933, -85771, -85567, -85320, -85032, -84701, -84330, -83917, -83464, -82971,
+  -82437, -81865, -81253, -80602, -79914, -79187, -78424, -77624, -76787, -75916,
+  -75009, -74067, -73092, -72084, -71043, -69970, -68865, -67730, -66565, -65371,
+  -64148, -62897, -61619, -60315, -58985, -57630, -56251, -54849, -53424, -51977,
+  -50510, -49022, -47515, -45989, -44446, -42885, -41309, -39718, -38112, -36493,
+  -34862, -33218, -31564, -29900, -28227, -26546, -24857, -23162, -21461, -19755,
+  -18046, -16334, -14619, -12904, -11187, -9472, -7758, -6046, -4337, -2632,
+  -932, 763, 2451, 4132, 5805, 7468, 9123, 10766, 12399, 14019,
+  15627, 17220, 18800, 20364, 21913, 23445, 24960, 26457, 27935, 29394,
+  30833, 32251, 33648, 35023, 36375, 37704, 39010, 40291, 41548, 42779,
+  43984, 45163, 46315, 47439, 48536, 49604, 50644, 51654, 52635, 53585,
+  54506, 55396, 56254, 57082, 57877, 58641, 59373, 60072, 60738, 61372,
+  61972, 62539, 63073, 63573, 64040, 64472, 64871, 65235, 65566, 65862,
+  66124, 66352, 66546, 66706, 66832, 66924, 66982, 67006, 66996, 66953,
+  66876, 66766, 66623, 66447, 66238, 65997, 65723, 65418, 65081, 64712,
+  64312, 63882, 63421, 62930, 62409, 61858, 61279, 60671, 60035, 59371,
+  58679, 57961, 57216, 56445, 55649, 54828, 53982, 53113, 52220, 51304,
+  50365, 49405, 48424, 47422, 46399, 45358, 44297, 43218, 42122, 41008,
+  39878, 38732, 37571, 36395, 35206, 34003, 32788, 31560, 30322, 29073,
+  27814, 26545, 25268, 23983, 22691, 21393, 20088, 18778, 17464, 16146,
+  14824, 13501, 12175, 10848, 9521, 8194, 6868, 5543, 4221, 2901,
+  1585, 273, -1034, -2335, -3631, -4920, -6201, -7475, -8740, -9996,
+  -11242, -12478, -13703, -14916, -16117, -17306, -18481, -19643, -20791, -21923,
+  -23040, -24142, -25227, -26296, -27347, -28380, -29396, -30392, -31370, -32328,
+  -33266, -34184, -35081, -35958, -36812, -37646, -38457, -39245, -40011, -40754,
+  -41474, -42170, -42842, -43490, -44113, -44713, -45287, -45836, -46361, -46860,
+  -47333, -47781, -48204, -48600, -48971, -49315, -49634, -49926, -50192, -50432,
+  -50645, -50832, -50993, -51128, -51237, -51319, -51375, -51406, -51410, -51389,
+  -51341, -51269, -51170, -51047, -50898, -50724, -50525, -50302, -50054, -49783,
+  -49487, -49167, -48824, -48458, -48069, -47657, -47223, -46767, -46290, -45790,
+  -45270, -44729, -44168, -43586, -42985, -42365, -41726, -41068, -40393, -39700,
+  -38989, -38262, -37518, -36758, -35983, -35193, -34388, -33569, -32737, -31891,
+  -31033, -30162, -29280, -28386, -27482, -26567, -25643, -24709, -23767, -22816,
+  -21858, -20892, -19920, -18942, -17958, -16969, -15975, -14977, -13976, -12971,
+  -11964, -10955, -9945, -8933, -7921, -6909, -5898, -4887, -3878, -2872,
+  -1867, -866, 131, 1125, 2114, 3098, 4076, 5049, 6015, 6974,
+  7926, 8871, 9806, 10734, 11652, 12560, 13459, 14347, 15225, 16091,
+  16946, 17789, 18619, 19437, 20242, 21033, 21811, 22574, 23323, 24058,
+  24777, 25481, 26169, 26841, 27498, 28137, 28760, 29366, 29955, 30526,
+  31080, 31615, 32133, 32633, 33114, 33576, 34020, 34444, 34850, 35237,
+  35604, 35952, 36280, 36589, 36878, 37147, 37397, 37627, 37837, 38027,
+  38197, 38347, 38478, 38588, 38679, 38750, 38801, 38832, 38844, 38836,
+  38808, 38761, 38695, 38610, 38506, 38382, 38240, 38079, 37900, 37703,
+  37487, 37253, 37002, 36733, 36446, 36143, 35822, 35485, 35131, 34762,
+  34376, 33974, 33557, 33125, 32678, 32217, 31741, 31251, 30748, 30231,
+  29701, 29158, 28603, 28036, 27457, 26867, 26265, 25653, 25031, 24398,
+  23756, 23105, 22445, 21776, 21099, 20414, 19722, 19023, 18317, 17605,
+  16887, 16164, 15435, 14702, 13965, 13223, 12478, 11730, 10979, 10226,
+  9470, 8714, 7956, 7197, 6437, 5678, 4919, 4161, 3404, 2648,
+  1894, 1143, 394, -352, -1095, -1834, -2569, -3299, -4025, -4745,
+  -5461, -6170, -6873, -7570, -8260, -8943, -9618, -10286, -10946, -11598,
+  -12240, -12874, -13499, -14114, -14720, -15316, -15901, -16476, -17040, -17593,
+  -18135, -18665, -19184, -19691, -20185, -20668, -21138, -21595, -22040, -22471,
+  -22889, -23294, -23686, -24064, -24428, -24778, -25115, -25437, -25745, -26039,
+  -26318, -26583, -26833, -27069, -27290, -27497, -27688, -27865, -28027, -28175,
+  -28307, -28425, -28528, -28616, -28689, -28747, -28791, -28820, -28835, -28834,
+  -28820, -28791, -28747, -28689, -28617, -28531, -28431, -28317, -28189, -28048,
+  -27893, -27725, -27544, -27349, -27142, -26921, -26689, -26444, -26186, -25917,
+  -25635, -25342, -25038, -24722, -24395, -24057, -23709, -23351, -22982, -22603,
+  -22214, -21816, -21409, -20993, -20568, -20135, -19693, -19243, -18786, -18322,
+  -17850, -17371, -16886, -16394, -15896, -15392, -14883, -14369, -13850, -13326,
+  -12798, -12265, -11729, -11190, -10647, -10101, -9552, -9002, -8449, -7894,
+  -7338, -6781, -6222, -5663, -5104, -4545, -3986, -3427, -2870, -2313,
+  -1758, -1204, -652, -102, 445, 989, 1531, 2069, 2604, 3135,
+  3662, 4185, 4704, 5217, 5726, 6229, 6728, 7220, 7707, 8187,
+  8661, 9129, 9590, 10044, 10490, 10930, 11362, 11786, 12202, 12611,
+  13011, 13403, 13786, 14160, 14526, 14882, 15230, 15568, 15897, 16216,
+  16526, 16825, 17115, 17395, 17665, 17925, 18175, 18414, 18643, 18861,
+  19069, 19267, 19453, 19629, 19795, 19949, 20093, 20226, 20348, 20459,
+  20560, 20650, 20728, 20796, 20854, 20900, 20936, 20961, 20975, 20979,
+  20972, 20954, 20926, 20888, 20839, 20780, 20711, 20631, 20542, 20442,
+  20333, 20214, 20086, 19948, 19800, 19643, 19477, 19302, 19118, 18926,
+  18724, 18514, 18296, 18070, 17835, 17593, 17343, 17085, 16820, 16548,
+  16269, 15983, 15690, 15390, 15085, 14773, 14455, 14131, 13802, 13467,
+  13127, 12783, 12433, 12079, 11720, 11357, 10990, 10620, 10245, 9868,
+  9487, 9103, 8717, 8328, 7936, 7543, 7147, 6750, 6352, 5952,
+  5551, 5149, 4747, 4344, 3940, 3537, 3134, 2731, 2329, 1928,
+  1527, 1128, 730, 334, -61, -453, -844, -1232, -1617, -2000,
+  -2380, -2757, -3131, -3502, -3868, -4232, -4591, -4946, -5297, -5643,
+  -5985, -6322, -6655, -6982, -7304, -7621, -7933, -8239, -8539, -8834,
+  -9123, -9405, -9682, -9952, -10216, -10473, -10724, -10968, -11206, -11436,
+  -11660, -11877, -12087, -12289, -12484, -12672, -12853, -13026, -13192, -13351,
+  -13502, -13645, -13780, -13909, -14029, -14142, -14247, -14344, -14433, -14515,
+  -14589, -14655, -14714, -14765, -14808, -14843, -14871, -14891, -14904, -14909,
+  -14906, -14896, -14878, -14853, -14820, -14781, -14733, -14679, -14618, -14549,
+  -14474, -14391, -14302, -14206, -14103, -13994, -13878, -13756, -13627, -13492,
+  -13351, -13204, -13051, -12892, -12728, -12557, -12382, -12201, -12015, -11823,
+  -11627, -11426, -11220, -11010, -10794, -10575, -10351, -10124, -9892, -9657,
+  -9418, -9175, -8929, -8680, -8427, -8172, -7914, -7653, -7389, -7124,
+  -6856, -6586, -6314, -6040, -5765, -5488, -5209, -4930, -4650, -4368,
+  -4086, -3803, -3520, -3237, -2953, -2670, -2386, -2103, -1820, -1538,
+  -1256, -975, -696, -417, -140, 136, 411, 684, 955, 1224,
+  1491, 1756, 2018, 2279, 2536, 2792, 3044, 3293, 3540, 3783,
+  4023, 4260, 4494, 4724, 4950, 5173, 5391, 5606, 5817, 6024,
+  6227, 6425, 6619, 6809, 6995, 7175, 7352, 7523, 7690, 7852,
+  8009, 8162, 8309, 8451, 8589, 8721, 8848, 8970, 9087, 9198,
+  9304, 9405, 9501, 9591, 9676, 9756, 9830, 9899, 9962, 10021,
+  10073, 10121, 10163, 10199, 10230, 10256, 10277, 10292, 10302, 10306,
+  10306, 10300, 10289, 10273, 10251, 10225, 10194, 10157, 10116, 10070,
+  10019, 9963, 9902, 9837, 9767, 9692, 9613, 9530, 9442, 9350,
+  9254, 9153, 9048, 8940, 8827, 8711, 8591, 8467, 8340, 8209,
+  8074, 7937, 7796, 7651, 7504, 7354, 7201, 7045, 6886, 6725,
+  6561, 6395, 6227, 6056, 5883, 5709, 5532, 5353, 5173, 4991,
+  4808, 4623, 4437, 4250, 4061, 3872, 3682, 3491, 3299, 3107,
+  2914, 2721, 2527, 2334, 2140, 1946, 1752, 1559, 1366, 1173,
+  981, 789, 599, 408, 219, 31, -156, -342, -527, -711,
+  -893, -1073, -1252, -1430, -1605, -1779, -1951, -2121, -2289, -2454,
+  -2618, -2779, -2938, -3094, -3248, -3400, -3549, -3695, -3838, -3979,
+  -4117, -4252, -4384, -4513, -4639, -4762, -4881, -4998, -5111, -5221,
+  -5328, -5432, -5532, -5629, -5722, -5812, -5898, -5981, -6060, -6136,
+  -6208, -6277, -6342, -6403, -6461, -6515, -6566, -6613, -6656, -6696,
+  -6732, -6764, -6793, -6818, -6839, -6857, -6872, -6882, -6890, -6893,
+  -6893, -6890, -6883, -6873, -6859, -6842, -6821, -6797, -6770, -6740,
+  -6706, -6669, -6629, -6586, -6539, -6490, -6438, -6382, -6324, -6263,
+  -6199, -6132, -6063, -5991, -5916, -5839, -5759, -5677, -5592, -5505,
+  -5416, -5325, -5231, -5136, -5038, -4939, -4837, -4734, -4629, -4522,
+  -4413, -4303, -4192, -4078, -3964, -3848, -3731, -3613, -3494, -3374,
+  -3252, -3130, -3007, -2883, -2759, -2634, -2508, -2382, -2255, -2128,
+  -2001, -1874, -1746, -1618, -1490, -1363, -1235, -1108, -980, -853,
+  -727, -601, -475, -350, -225, -102, 22, 144, 265, 386,
+  506, 624, 742, 858, 973, 1087, 1200, 1312, 1422, 1530,
+  1637, 1743, 1847, 1949, 2050, 2149, 2247, 2342, 2436, 2528,
+  2618, 2706, 2793, 2877, 2959, 3039, 3117, 3194, 3267, 3339,
+  3409, 3476, 3541, 3604, 3665, 3724, 3780, 3834, 3885, 3935,
+  3982, 4026, 4068, 4108, 4146, 4181, 4214, 4244, 4273, 4298,
+  4322, 4343, 4361, 4378, 4392, 4403, 4413, 4420, 4424, 4427,
+  4427, 4425, 4420, 4414, 4405, 4394, 4381, 4365, 4348, 4328,
+  4306, 4283, 4257, 4229, 4200, 4168, 4134, 4099, 4062, 4022,
+  3981, 3939, 3894, 3848, 3800, 3751, 3700, 3647, 3593, 3538,
+  3481, 3423, 3363, 3302, 3240, 3176, 3111, 3045, 2978, 2910,
+  2841, 2771, 2700, 2628, 2556, 2482, 2408, 2333, 2257, 2181,
+  2104, 2026, 1948, 1870, 1791, 1712, 1632, 1552, 1472, 1392,
+  1312, 1231, 1150, 1070, 989, 908, 828, 748, 667, 587,
+  508, 428, 349, 271, 192, 115, 37, -40, -116, -191,
+  -267, -341, -414, -487, -560, -631, -701, -771, -840, -908,
+  -975, -1041, -1105, -1169, -1232, -1294, -1355, -1414, -1472, -1530,
+  -1586, -1640, -1694, -1746, -1797, -1847, -1895, -1942, -1988, -2033,
+  -2076, -2117, -2157, -2196, -2234, -2270, -2304, -2338, -2369, -2400,
+  -2428, -2456, -2482, -2506, -2529, -2551, -2571, -2589, -2606, -2622,
+  -2636, -2649, -2660, -2670, -2678, -2685, -2691, -2695, -2697, -2699,
+  -2698, -2697, -2694, -2690, -2684, -2677, -2669, -2659, -2648, -2636,
+  -2622, -2608, -2592, -2575, -2556, -2537, -2516, -2494, -2471, -2447,
+  -2422, -2396, -2369, -2341, -2311, -2281, -2250, -2218, -2185, -2151,
+  -2117, -2081, -2045, -2008, -1970, -1931, -1892, -1852, -1812, -1770,
+  -1729, -1686, -1643, -1600, -1556, -1512, -1467, -1422, -1376, -1330,
+  -1284, -1237, -1191, -1144, -1096, -1049, -1001, -953, -905, -857,
+  -809, -761, -713, -665, -617, -569, -521, -473, -425, -378,
+  -331, -284, -237, -190, -144, -98, -52, -6, 39, 83,
+  127, 171, 215, 258, 300, 342, 383, 424, 465, 504,
+  544, 582, 620, 657, 694, 730, 765, 800, 834, 867,
+  900, 932, 963, 993, 1023, 1051, 1079, 1106, 1133, 1158,
+  1183, 1207, 1230, 1252, 1274, 1294, 1314, 1333, 1351, 1368,
+  1385, 1400, 1415, 1429, 1441, 1453, 1465, 1475, 1484, 1493,
+  1501, 1508, 1514, 1519, 1524, 1527, 1530, 1532, 1533, 1533,
+  1533, 1531, 1529, 1527, 1523, 1519, 1513, 1508, 1501, 1494,
+  1486, 1477, 1467, 1457, 1446, 1435, 1423, 1410, 1397, 1383,
+  1368, 1353, 1337, 1321, 1304, 1287, 1269, 1251, 1232, 1212,
+  1193, 1172, 1152, 1131, 1109, 1087, 1065, 1042, 1019, 996,
+  972, 949, 924, 900, 875, 850, 825, 800, 774, 749,
+  723, 697, 671, 645, 618, 592, 565, 539, 512, 486,
+  459, 433, 406, 380, 353, 327, 300, 274, 248, 222,
+  196, 170, 145, 119, 94, 69, 44, 20, -5, -29,
+  -53, -77, -100, -123, -146, -169, -191, -213, -234, -256,
+  -277, -297, -317, -337, -357, -376, -394, -413, -431, -448,
+  -465, -482, -498, -514, -530, -545, -559, -573, -587, -600,
+  -613, -625, -637, -649, -660, -670, -680, -690, -699, -707,
+  -716, -723, -731, -737, -744, -750, -755, -760, -765, -769,
+  -772, -775, -778, -780, -782, -784, -785, -785, -785, -785,
+  -784, -783, -782, -780, -777, -775, -771, -768, -764, -760,
+  -755, -750, -745, -740, -734, -727, -721, -714, -707, -699,
+  -691, -683, -675, -666, -657, -648, -639, -629, -619, -609,
+  -599, -588, -577, -566, -555, -544, -533, -521, -509, -497,
+  -485, -473, -461, -448, -436, -423, -411, -398, -385, -372,
+  -359, -346, -333, -320, -307, -294, -281, -268, -255, -242,
+  -229, -216, -203, -190, -177, -164, -151, -139, -126, -114,
+  -101, -89, -76, -64, -52, -40, -29, -17, -5, 6,
+  17, 29, 39, 50, 61, 71, 82, 92, 102, 112,
+  121, 131, 140, 149, 158, 166, 175, 183, 191, 199,
+  207, 214, 221, 228, 235, 242, 248, 254, 260, 266,
+  271, 276, 281, 286, 291, 295, 299, 303, 307, 310,
+  313, 316, 319, 322, 324, 326, 328, 330, 332, 333,
+  334, 335, 336, 336, 337, 337, 337, 336, 336, 335,
+  334, 334, 332, 331, 330, 328, 326, 324, 322, 320,
+  317, 315, 312, 309, 306, 303, 300, 296, 293, 289,
+  285, 282, 278, 274, 270, 265, 261, 257, 252, 248,
+  243, 238, 233, 229, 224, 219, 214, 209, 204, 199,
+  193, 188, 183, 178, 173, 167, 162, 157, 151, 146,
+  141, 135, 130, 125, 120, 114, 109, 104, 99, 94,
+  88, 83, 78, 73, 68, 63, 59, 54, 49, 44,
+  40, 35, 30, 26, 22, 17, 13, 9, 5, 0,
+  -4, -7, -11, -15, -19, -22, -26, -29, -33, -36,
+  -39, -42, -45, -48, -51, -54, -56
+};
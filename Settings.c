@@ -0,0 +1,166 @@
+/*
+ * File: Settings.c
+ *
+ * Description: Selected output and volume, kept in an NVRAM variable.
+ *
+ * Copyright (c) 2018-2019 John Davis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "AudioDxeCfg.h"
+
+STATIC EFI_GUID   mAudioSettingsGuid  = AUDIO_SETTINGS_VARIABLE_GUID;
+
+// Record last read or written, so unchanged settings are not written again.
+STATIC UINT8      *mSettingsRecord    = NULL;
+STATIC UINTN      mSettingsSize       = 0;
+
+EFI_STATUS
+SettingsLoad (
+  IN  AUDIO_DEVICE  *Devices,
+  IN  UINTN         DevicesCount,
+  OUT UINTN         *DeviceIndex,
+  OUT UINT8         *Volume,
+  OUT BOOLEAN       *SoftwareVolume
+  )
+{
+  EFI_STATUS                  Status;
+  AUDIO_SETTINGS_RECORD       *Record;
+  EFI_DEVICE_PATH_PROTOCOL    *DevicePath;
+  UINTN                       DevicePathSize;
+  UINTN                       Size;
+  UINTN                       i;
+
+  //
+
+  Record  = AllocatePool (AUDIO_SETTINGS_MAX_SIZE);
+  if (Record == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Size    = AUDIO_SETTINGS_MAX_SIZE;
+  Status  = gRT->GetVariable (AUDIO_SETTINGS_VARIABLE_NAME, &mAudioSettingsGuid, NULL, &Size, Record);
+  if (EFI_ERROR (Status)) {
+    FreePool (Record);
+    return Status;
+  }
+
+  DevicePath      = (EFI_DEVICE_PATH_PROTOCOL *)(Record + 1);
+  DevicePathSize  = Size - sizeof (*Record);
+  if ((Size < sizeof (*Record))
+    || (Record->Signature != AUDIO_SETTINGS_SIGNATURE)
+    || (Record->Version != AUDIO_SETTINGS_VERSION)
+    || !IsDevicePathValid (DevicePath, DevicePathSize)) {
+    FreePool (Record);
+    return EFI_VOLUME_CORRUPTED;
+  }
+
+  mSettingsRecord = (UINT8 *)Record;
+  mSettingsSize   = Size;
+
+  *Volume         = MIN (Record->Volume, EFI_AUDIO_IO_PROTOCOL_MAX_VOLUME);
+  *SoftwareVolume = (Record->Flags & AUDIO_SETTINGS_SOFTWARE_VOLUME) != 0;
+
+  // The output may be gone, volume is restored regardless.
+  for (i = 0; i < DevicesCount; i++) {
+    if ((Devices[i].OutputPortIndex == Record->OutputPortIndex)
+      && (GetDevicePathSize (Devices[i].DevicePath) == DevicePathSize)
+      && (CompareMem (Devices[i].DevicePath, DevicePath, DevicePathSize) == 0)) {
+      *DeviceIndex = i;
+      return EFI_SUCCESS;
+    }
+  }
+
+  return EFI_NOT_FOUND;
+}
+
+EFI_STATUS
+SettingsSave (
+  IN  AUDIO_DEVICE  *Device,
+  IN  UINT8         Volume,
+  IN  BOOLEAN       SoftwareVolume
+  )
+{
+  EFI_STATUS              Status;
+  AUDIO_SETTINGS_RECORD   *Record;
+  UINTN                   DevicePathSize;
+  UINTN                   Size;
+
+  //
+
+  if ((Device == NULL) || (Device->OutputPortIndex > MAX_UINT8)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  DevicePathSize  = GetDevicePathSize (Device->DevicePath);
+  Size            = sizeof (*Record) + DevicePathSize;
+  if (Size > AUDIO_SETTINGS_MAX_SIZE) {
+    return EFI_BUFFER_TOO_SMALL;
+  }
+
+  Record = AllocatePool (Size);
+  if (Record == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Record->Signature       = AUDIO_SETTINGS_SIGNATURE;
+  Record->Version         = AUDIO_SETTINGS_VERSION;
+  Record->Volume          = Volume;
+  Record->Flags           = SoftwareVolume ? AUDIO_SETTINGS_SOFTWARE_VOLUME : 0;
+  Record->OutputPortIndex = (UINT8)Device->OutputPortIndex;
+  CopyMem (Record + 1, Device->DevicePath, DevicePathSize);
+
+  // Flash writes are slow and wear the part, skip them when nothing changed.
+  if ((mSettingsRecord != NULL) && (mSettingsSize == Size) && (CompareMem (mSettingsRecord, Record, Size) == 0)) {
+    FreePool (Record);
+    return EFI_SUCCESS;
+  }
+
+  Status = gRT->SetVariable (
+    AUDIO_SETTINGS_VARIABLE_NAME,
+    &mAudioSettingsGuid,
+    EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS,
+    Size,
+    Record
+    );
+  if (EFI_ERROR (Status)) {
+    FreePool (Record);
+    return Status;
+  }
+
+  if (mSettingsRecord != NULL) {
+    FreePool (mSettingsRecord);
+  }
+  mSettingsRecord = (UINT8 *)Record;
+  mSettingsSize   = Size;
+
+  return EFI_SUCCESS;
+}
+
+VOID
+SettingsFree (
+  VOID
+  )
+{
+  if (mSettingsRecord != NULL) {
+    FreePool (mSettingsRecord);
+    mSettingsRecord = NULL;
+  }
+}
@@ -0,0 +1,294 @@
+/*
+ * File: Tone.c
+ *
+ * Description: Generated test signal sources.
+ *
+ * Copyright (c) 2018-2019 John Davis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "AudioDxeCfg.h"
+
+// Quarter sine wave, 64 steps plus the peak, full scale 16-bit.
+STATIC CONST INT16 mQuarterSine[65] = {
+  0,     804,   1608,  2410,  3212,  4011,  4808,  5602,  6393,  7179,  7962,  8739,  9512,
+  10278, 11039, 11793, 12539, 13279, 14010, 14732, 15446, 16151, 16846, 17530, 18204, 18868,
+  19519, 20159, 20787, 21403, 22005, 22594, 23170, 23731, 24279, 24811, 25329, 25832, 26319,
+  26790, 27245, 27683, 28105, 28510, 28898, 29268, 29621, 29956, 30273, 30571, 30852, 31113,
+  31356, 31580, 31785, 31971, 32137, 32285, 32412, 32521, 32609, 32678, 32728, 32757, 32767
+};
+
+STATIC
+INT32
+ToneSine (
+  IN  UINT8   Index
+  )
+{
+  UINT8   Position;
+
+  //
+
+  Position = Index & 63;
+
+  switch (Index >> 6) {
+    case 0:
+      return mQuarterSine[Position];
+
+    case 1:
+      return mQuarterSine[64 - Position];
+
+    case 2:
+      return -mQuarterSine[Position];
+
+    default:
+      return -mQuarterSine[64 - Position];
+  }
+}
+
+/**
+  Next white noise sample from the xorshift generator, 16-bit signed.
+**/
+STATIC
+INT32
+ToneNoise (
+  IN OUT TONE_SOURCE  *Source
+  )
+{
+  UINT32  Seed;
+
+  //
+
+  Seed          = Source->Seed;
+  Seed         ^= Seed << 13;
+  Seed         ^= Seed >> 17;
+  Seed         ^= Seed << 5;
+  Source->Seed  = Seed;
+
+  return (INT32)(Seed >> 16) - 0x8000;
+}
+
+/**
+  Pink noise by the Voss-McCartney method: each row holds white noise
+  refreshed half as often as the one before, so their sum falls off at
+  3 dB per octave.
+**/
+STATIC
+INT32
+TonePinkNoise (
+  IN OUT TONE_SOURCE  *Source
+  )
+{
+  UINTN   Row;
+  INT32   Value;
+
+  //
+
+  // Row to refresh is the number of trailing zeros of the position.
+  if (Source->Position != 0) {
+    for (Row = 0; (Row < (TONE_PINK_ROWS - 1)) && (((Source->Position >> Row) & 1) == 0); Row++);
+    Source->RowSum          -= Source->Rows[Row];
+    Source->Rows[Row]        = ToneNoise (Source) / (TONE_PINK_ROWS + 1);
+    Source->RowSum          += Source->Rows[Row];
+  }
+
+  Value = Source->RowSum + ToneNoise (Source) / (TONE_PINK_ROWS + 1);
+
+  return (Value * 2 * Source->Amplitude) >> 15;
+}
+
+/**
+  Sine at the current phase, interpolated between table steps, scaled to the
+  amplitude, 16-bit signed. The phase is advanced.
+**/
+STATIC
+INT32
+ToneNextSine (
+  IN OUT TONE_SOURCE  *Source
+  )
+{
+  INT32   Sample;
+  INT32   Next;
+  UINT8   Index;
+
+  //
+
+  Index   = (UINT8)(Source->Phase >> 24);
+  Sample  = ToneSine (Index);
+  Next    = ToneSine ((UINT8)(Index + 1));
+  Sample += ((Next - Sample) * (INT32)((Source->Phase >> 8) & 0xFFFF)) >> 16;
+
+  Source->Phase += Source->PhaseStep;
+
+  return (Sample * Source->Amplitude) >> 15;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+ToneSourceRead (
+  IN  AUDIO_SOURCE  *This,
+  OUT UINT8         *Buffer,
+  IN  UINTN         Length,
+  OUT UINTN         *ReadLength
+  )
+{
+  TONE_SOURCE   *Source;
+  UINTN         Samples;
+  UINTN         BytesPerSample;
+  INT32         Sample;
+  UINTN         Segment;
+  UINTN         Offset;
+  UINTN         Ramp;
+  UINT8         Active;
+  UINTN         i;
+  UINT8         c;
+
+  //
+
+  Source          = BASE_CR (This, TONE_SOURCE, Source);
+  BytesPerSample  = AudioIoBytesPerSample (This->Bits);
+
+  if (Source->Position >= This->TotalSamples) {
+    *ReadLength = 0;
+    return EFI_END_OF_FILE;
+  }
+
+  Samples = MIN (Length / (This->Channels * BytesPerSample), This->TotalSamples - Source->Position);
+  Active  = MAX_UINT8;
+
+  for (i = 0; i < Samples; i++) {
+    switch (Source->Signal) {
+      case ToneSignalSweep:
+        Sample                = ToneNextSine (Source);
+        Source->SweepStep    += Source->SweepDelta;
+        Source->PhaseStep     = (UINT32)RShiftU64 (Source->SweepStep, 16);
+        break;
+
+      case ToneSignalPinkNoise:
+        Sample = TonePinkNoise (Source);
+        break;
+
+      case ToneSignalChannelId:
+        // Each channel in turn, the n-th at n times the tone, ramped at segment edges.
+        Segment = Source->Position / Source->SegmentLength;
+        Offset  = Source->Position % Source->SegmentLength;
+        if (Offset == 0) {
+          Source->Phase     = 0;
+          Source->PhaseStep = Source->BaseStep * (UINT32)((Segment % This->Channels) + 1);
+        }
+
+        Active  = (UINT8)(Segment % This->Channels);
+        Ramp    = MIN (MIN (Offset, Source->SegmentLength - Offset), TONE_RAMP_SAMPLES);
+        Sample  = (ToneNextSine (Source) * (INT32)Ramp) / TONE_RAMP_SAMPLES;
+        break;
+
+      case ToneSignalImpulse:
+        Sample = ((Source->Position % Source->SegmentLength) == 0) ? (2 * Source->Amplitude - 1) : 0;
+        break;
+
+      default:
+        Sample = ToneNextSine (Source);
+        break;
+    }
+
+    for (c = 0; c < This->Channels; c++) {
+      ConvertStoreSample (Buffer, This->Bits, ((Active == MAX_UINT8) || (Active == c)) ? (INT32)((UINT32)Sample << 16) : 0);
+      Buffer += BytesPerSample;
+    }
+
+    Source->Position++;
+  }
+
+  *ReadLength = Samples * This->Channels * BytesPerSample;
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+ToneSourceRewind (
+  IN  AUDIO_SOURCE  *This
+  )
+{
+  TONE_SOURCE   *Source;
+
+  //
+
+  Source            = BASE_CR (This, TONE_SOURCE, Source);
+  Source->Phase     = 0;
+  Source->PhaseStep = Source->BaseStep;
+  Source->SweepStep = LShiftU64 (Source->BaseStep, 16);
+  Source->Position  = 0;
+  Source->Seed      = TONE_NOISE_SEED;
+  Source->RowSum    = 0;
+  ZeroMem (Source->Rows, sizeof (Source->Rows));
+
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+ToneSourceInit (
+  OUT TONE_SOURCE                 *Source,
+  IN  EFI_AUDIO_IO_PROTOCOL_FREQ  Frequency,
+  IN  EFI_AUDIO_IO_PROTOCOL_BITS  Bits,
+  IN  UINT8                       Channels,
+  IN  TONE_SIGNAL                 Signal,
+  IN  UINT32                      ToneHz,
+  IN  UINT32                      Length
+  )
+{
+  UINT32    Hz;
+  UINT32    EndHz;
+  UINT32    EndStep;
+
+  //
+
+  Hz = AudioIoFreqToHz (Frequency);
+  if ((Hz == 0) || (Channels == 0) || (Signal == 0) || (Signal >= ToneSignalMax) || (ToneHz == 0) || (ToneHz >= (Hz / 2))) {
+    return EFI_UNSUPPORTED;
+  }
+
+  // Channel tones must stay below Nyquist too.
+  if ((Signal == ToneSignalChannelId) && ((ToneHz * Channels) >= (Hz / 2))) {
+    return EFI_UNSUPPORTED;
+  }
+
+  Source->Source.Read         = ToneSourceRead;
+  Source->Source.Rewind       = ToneSourceRewind;
+  Source->Source.Frequency    = Frequency;
+  Source->Source.Bits         = Bits;
+  Source->Source.Channels     = Channels;
+  Source->Source.TotalSamples = (UINTN)DivU64x32 (MultU64x32 (Hz, Length), 1000);
+  Source->Signal              = Signal;
+  Source->BaseStep            = (UINT32)DivU64x32 (LShiftU64 (ToneHz, 32), Hz);
+  Source->Amplitude           = TONE_AMPLITUDE;
+  Source->SweepDelta          = 0;
+  Source->SegmentLength       = (UINTN)DivU64x32 (MultU64x32 (Hz, TONE_SEGMENT_LENGTH), 1000);
+
+  // Sweeps run from the tone up to just below Nyquist, or 20 kHz at most.
+  if ((Signal == ToneSignalSweep) && (Source->Source.TotalSamples > 0)) {
+    EndHz                 = MIN (TONE_SWEEP_END, Hz / 2 - Hz / 20);
+    EndStep               = (UINT32)DivU64x32 (LShiftU64 (MAX (EndHz, ToneHz), 32), Hz);
+    Source->SweepDelta    = DivU64x32 (LShiftU64 (EndStep - Source->BaseStep, 16), (UINT32)Source->Source.TotalSamples);
+  }
+
+  return ToneSourceRewind (&Source->Source);
+}
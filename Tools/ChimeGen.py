@@ -0,0 +1,344 @@
+#!/usr/bin/env python3
+#
+# File: ChimeGen.py
+#
+# Description: Generates pre-decoded chime data for AudioDxeCfg.
+#
+# Copyright (c) 2018-2019 John Davis
+#
+# Converts an audio file into raw PCM in the target device format and emits
+# it as a C source defining mChimeData, mChimeDataLength and the format
+# globals (mChimeDataFreq, mChimeDataBits, mChimeDataChannels), so the
+# application can play it without decoding.
+#
+# With --adpcm, the chime is compressed 4:1 to 16-bit IMA ADPCM instead, in
+# blocks that each restart from a stored sample. The format globals are left
+# zero and the data carries its own header, which Adpcm.c recognizes and
+# decodes as the chime is played.
+#
+# WAV input (PCM or IEEE float) is handled natively. Other formats, and sample
+# rate conversion, require ffmpeg to be available in PATH.
+#
+# Usage:
+#   ChimeGen.py input.mp3 -o ChimePcmData.c --freq 48000 --bits 16 --channels 2
+#   ChimeGen.py input.wav -o ChimeAdpcmData.c --adpcm
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+
+import argparse
+import math
+import os
+import shutil
+import struct
+import subprocess
+import sys
+
+# EFI_AUDIO_IO_PROTOCOL_FREQ names by sample rate.
+FREQS = {
+  8000:   'EfiAudioIoFreq8kHz',
+  11025:  'EfiAudioIoFreq11kHz',
+  16000:  'EfiAudioIoFreq16kHz',
+  22050:  'EfiAudioIoFreq22kHz',
+  32000:  'EfiAudioIoFreq32kHz',
+  44100:  'EfiAudioIoFreq44kHz',
+  48000:  'EfiAudioIoFreq48kHz',
+  88200:  'EfiAudioIoFreq88kHz',
+  96000:  'EfiAudioIoFreq96kHz',
+  192000: 'EfiAudioIoFreq192kHz',
+}
+
+# EFI_AUDIO_IO_PROTOCOL_BITS names by sample width.
+BITS = {
+  8:  'EfiAudioIoBits8',
+  16: 'EfiAudioIoBits16',
+  20: 'EfiAudioIoBits20',
+  24: 'EfiAudioIoBits24',
+  32: 'EfiAudioIoBits32',
+}
+
+WAVE_FORMAT_PCM        = 0x0001
+WAVE_FORMAT_IEEE_FLOAT = 0x0003
+WAVE_FORMAT_EXTENSIBLE = 0xFFFE
+
+VALUES_PER_LINE = 24
+
+# IMA ADPCM tables, must match Adpcm.c.
+ADPCM_SIGNATURE   = b'ADPM'
+ADPCM_INDEX_TABLE = [-1, -1, -1, -1, 2, 4, 6, 8]
+ADPCM_STEP_TABLE  = [
+  7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+  50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+  253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+  1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+  3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+  11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+  32767
+]
+
+
+def read_wave(data):
+  """Parse a RIFF/WAVE image, returns (rate, channels, frames) with frames
+  being a list of per-frame sample tuples normalized to signed 32-bit."""
+  if len(data) < 12 or data[0:4] != b'RIFF' or data[8:12] != b'WAVE':
+    raise ValueError('not a RIFF/WAVE file')
+
+  fmt = None
+  pcm = None
+  offset = 12
+  while offset + 8 <= len(data):
+    chunk_id, chunk_size = struct.unpack_from('<4sI', data, offset)
+    body = data[offset + 8:offset + 8 + chunk_size]
+    if chunk_id == b'fmt ':
+      fmt = body
+    elif chunk_id == b'data':
+      pcm = body
+    offset += 8 + chunk_size + (chunk_size & 1)
+
+  if fmt is None or pcm is None:
+    raise ValueError('missing fmt or data chunk')
+
+  tag, channels, rate, _, block_align, bits = struct.unpack_from('<HHIIHH', fmt, 0)
+  if tag == WAVE_FORMAT_EXTENSIBLE and len(fmt) >= 26:
+    tag = struct.unpack_from('<H', fmt, 24)[0]
+
+  width = block_align // channels
+  count = len(pcm) // block_align
+  samples = []
+
+  if tag == WAVE_FORMAT_IEEE_FLOAT and width == 4:
+    for (value,) in struct.iter_unpack('<f', pcm[:count * block_align]):
+      samples.append(max(-0x80000000, min(0x7FFFFFFF, int(value * 0x80000000))))
+  elif tag == WAVE_FORMAT_PCM and width in (1, 2, 3, 4):
+    for i in range(count * channels):
+      raw = pcm[i * width:(i + 1) * width]
+      if width == 1:
+        value = (raw[0] - 0x80) << 24
+      else:
+        value = int.from_bytes(raw, 'little', signed=True) << (32 - width * 8)
+      samples.append(value)
+  else:
+    raise ValueError('unsupported WAVE format tag 0x%04X, %u-bit' % (tag, bits))
+
+  frames = [tuple(samples[i:i + channels]) for i in range(0, len(samples), channels)]
+  return rate, channels, frames
+
+
+def decode_ffmpeg(path, rate):
+  """Decode any input with ffmpeg into 32-bit PCM WAVE at the given rate."""
+  if shutil.which('ffmpeg') is None:
+    raise ValueError('ffmpeg is required to decode or resample %s' % path)
+
+  command = ['ffmpeg', '-v', 'error', '-i', path, '-f', 'wav', '-acodec', 'pcm_s32le']
+  if rate is not None:
+    command += ['-ar', str(rate)]
+  command += ['-']
+  return subprocess.run(command, check=True, stdout=subprocess.PIPE).stdout
+
+
+def remix(frames, channels, target):
+  """Convert channel count, averaging down to mono or duplicating up."""
+  if channels == target:
+    return frames
+  if target == 1:
+    return [(sum(frame) // channels,) for frame in frames]
+  return [tuple(frame[i % channels] for i in range(target)) for frame in frames]
+
+
+def trim(frames, threshold):
+  """Drop leading and trailing frames below the threshold."""
+  loud = [i for i, frame in enumerate(frames) if max(abs(s) for s in frame) > threshold]
+  if not loud:
+    return []
+  return frames[loud[0]:loud[-1] + 1]
+
+
+def encode(frames, bits):
+  """Pack frames in device format. Samples wider than 16 bits are stored
+  MSB-aligned in 32-bit containers, as HD audio streams expect."""
+  out = bytearray()
+  for frame in frames:
+    for sample in frame:
+      if bits == 8:
+        out.append(((sample >> 24) + 0x80) & 0xFF)
+      elif bits == 16:
+        out += struct.pack('<h', sample >> 16)
+      else:
+        mask = (0xFFFFFFFF << (32 - bits)) & 0xFFFFFFFF
+        out += struct.pack('<I', (sample & 0xFFFFFFFF) & mask)
+  return bytes(out)
+
+
+def adpcm_step(code, predictor, index):
+  """Decode one code, exactly as Adpcm.c does."""
+  step = ADPCM_STEP_TABLE[index]
+  diff = step >> 3
+  if code & 4:
+    diff += step
+  if code & 2:
+    diff += step >> 1
+  if code & 1:
+    diff += step >> 2
+  predictor = max(-32768, min(32767, predictor - diff if code & 8 else predictor + diff))
+  index = max(0, min(len(ADPCM_STEP_TABLE) - 1, index + ADPCM_INDEX_TABLE[code & 7]))
+  return predictor, index
+
+
+def encode_adpcm(frames, rate, channels, block_frames):
+  """Compress 16-bit frames to IMA ADPCM blocks. Returns the data and the
+  frames as the decoder will reproduce them."""
+  out = bytearray(struct.pack('<4sIHHI', ADPCM_SIGNATURE, rate, channels, block_frames, len(frames)))
+  decoded = []
+  predictor = [0] * channels
+  index = [0] * channels
+
+  for start in range(0, len(frames), block_frames):
+    block = [[s >> 16 for s in frame] for frame in frames[start:start + block_frames]]
+    for c in range(channels):
+      predictor[c] = block[0][c]
+      out += struct.pack('<hBB', predictor[c], index[c], 0)
+    decoded.append(tuple(predictor))
+
+    codes = []
+    for frame in block[1:]:
+      for c in range(channels):
+        step = ADPCM_STEP_TABLE[index[c]]
+        diff = frame[c] - predictor[c]
+        code = 0
+        if diff < 0:
+          code = 8
+          diff = -diff
+        if diff >= step:
+          code |= 4
+          diff -= step
+        if diff >= step >> 1:
+          code |= 2
+          diff -= step >> 1
+        if diff >= step >> 2:
+          code |= 1
+        predictor[c], index[c] = adpcm_step(code, predictor[c], index[c])
+        codes.append(code)
+      decoded.append(tuple(predictor))
+
+    if len(codes) & 1:
+      codes.append(0)
+    out += bytes(codes[i] | (codes[i + 1] << 4) for i in range(0, len(codes), 2))
+
+  return bytes(out), decoded
+
+
+def snr(frames, decoded):
+  signal = sum((s >> 16) ** 2 for frame in frames for s in frame)
+  noise = sum(((s >> 16) - d) ** 2 for frame, dec in zip(frames, decoded) for s, d in zip(frame, dec))
+  return 10 * math.log10(signal / max(noise, 1))
+
+
+def emit(output, source, data, rate, bits, channels, adpcm=False):
+  name = os.path.basename(output)
+  lines = []
+  for i in range(0, len(data), VALUES_PER_LINE):
+    lines.append('  ' + ','.join(str(b) for b in data[i:i + VALUES_PER_LINE]))
+
+  with open(output, 'w', newline='\n') as f:
+    f.write('/*\n')
+    f.write(' * File: %s\n' % name)
+    f.write(' *\n')
+    if adpcm:
+      f.write(' * Description: IMA ADPCM compressed chime at %u Hz, %u channel(s).\n' % (rate, channels))
+    else:
+      f.write(' * Description: Pre-decoded chime at %u Hz, %u-bit, %u channel(s).\n' % (rate, bits, channels))
+    f.write(' *\n')
+    f.write(' * Generated by Tools/ChimeGen.py from %s, do not edit.\n' % os.path.basename(source))
+    f.write(' *\n')
+    f.write(' */\n\n')
+    f.write('#include <Protocol/AudioIo.h>\n\n')
+    f.write('//\n// %s chime data.\n//\n' % ('Compressed' if adpcm else 'Pre-decoded'))
+    f.write('UINT8 mChimeData[] = {\n')
+    f.write(',\n'.join(lines))
+    f.write('\n};\n\n')
+    f.write('UINTN mChimeDataLength = %u;\n\n' % len(data))
+    if adpcm:
+      # Format is in the data header.
+      f.write('EFI_AUDIO_IO_PROTOCOL_FREQ mChimeDataFreq = 0;\n')
+      f.write('EFI_AUDIO_IO_PROTOCOL_BITS mChimeDataBits = 0;\n')
+      f.write('UINT8 mChimeDataChannels = 0;\n')
+    else:
+      f.write('EFI_AUDIO_IO_PROTOCOL_FREQ mChimeDataFreq = %s;\n' % FREQS[rate])
+      f.write('EFI_AUDIO_IO_PROTOCOL_BITS mChimeDataBits = %s;\n' % BITS[bits])
+      f.write('UINT8 mChimeDataChannels = %u;\n' % channels)
+
+
+def main():
+  parser = argparse.ArgumentParser(description='Generate pre-decoded chime data for AudioDxeCfg.')
+  parser.add_argument('input', help='input audio file')
+  parser.add_argument('-o', '--output', default='ChimePcmData.c', help='output C source')
+  parser.add_argument('--freq', type=int, default=48000, choices=sorted(FREQS), help='target sample rate')
+  parser.add_argument('--bits', type=int, default=16, choices=sorted(BITS), help='target sample width')
+  parser.add_argument('--channels', type=int, default=2, choices=(1, 2), help='target channel count')
+  parser.add_argument('--trim', type=int, default=0, metavar='LEVEL',
+                      help='trim leading/trailing samples below LEVEL (16-bit scale)')
+  parser.add_argument('--adpcm', action='store_true', help='compress to 16-bit IMA ADPCM, --bits is ignored')
+  parser.add_argument('--block-frames', type=int, default=1024, metavar='FRAMES',
+                      help='ADPCM frames per independently decodable block')
+  args = parser.parse_args()
+
+  with open(args.input, 'rb') as f:
+    image = f.read()
+
+  try:
+    try:
+      rate, channels, frames = read_wave(image)
+    except ValueError:
+      rate, channels, frames = read_wave(decode_ffmpeg(args.input, args.freq))
+
+    if rate != args.freq:
+      rate, channels, frames = read_wave(decode_ffmpeg(args.input, args.freq))
+  except (ValueError, subprocess.CalledProcessError) as e:
+    print('ChimeGen: %s' % e, file=sys.stderr)
+    return 1
+
+  frames = remix(frames, channels, args.channels)
+  if args.trim > 0:
+    frames = trim(frames, args.trim << 16)
+
+  if args.adpcm:
+    if not frames or not 2 <= args.block_frames <= 0xFFFF:
+      print('ChimeGen: nothing to compress or bad block size', file=sys.stderr)
+      return 1
+
+    data, decoded = encode_adpcm(frames, args.freq, args.channels, args.block_frames)
+    # Raw data for AudioDxeCfgChime.adp next to the application, C source otherwise.
+    if args.output.lower().endswith('.adp'):
+      with open(args.output, 'wb') as f:
+        f.write(data)
+    else:
+      emit(args.output, args.input, data, args.freq, 16, args.channels, adpcm=True)
+    print('ChimeGen: wrote %s, %u bytes of ADPCM for %u bytes of 16-bit PCM, SNR %.1f dB'
+          % (args.output, len(data), len(frames) * args.channels * 2, snr(frames, decoded)))
+    return 0
+
+  data = encode(frames, args.bits)
+  emit(args.output, args.input, data, args.freq, args.bits, args.channels)
+
+  print('ChimeGen: wrote %s, %u bytes of PCM' % (args.output, len(data)))
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
@@ -0,0 +1,190 @@
+#!/usr/bin/env python3
+#
+# File: FilterGen.py
+#
+# Description: Generates the resampler prototype filter for AudioDxeCfg.
+#
+# Copyright (c) 2018-2019 John Davis
+#
+# Emits ResampleFilter.c, holding one side of a Kaiser windowed sinc lowpass
+# sampled RESAMPLE_FILTER_RESOLUTION times per zero crossing. The application
+# derives polyphase coefficient tables for each rate pair from it.
+#
+# With --check, the filter response is measured, and the fixed-point
+# resampler of Resample.c is modeled to convert a reference sine between the
+# common rates, reporting the error against the ideal output.
+#
+# Usage:
+#   FilterGen.py -o ResampleFilter.c
+#   FilterGen.py --check
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+
+import argparse
+import math
+import os
+import sys
+
+# Must match AudioDxeCfg.h.
+ZERO_CROSSINGS = 32
+RESOLUTION     = 128
+ONE            = 1 << 24
+COEF_SHIFT     = 30
+
+VALUES_PER_LINE = 10
+
+
+def bessel_i0(x):
+  total = 1.0
+  term = 1.0
+  k = 1
+  while term > 1e-12 * total:
+    term *= (x / (2.0 * k)) ** 2
+    total += term
+    k += 1
+  return total
+
+
+def prototype(cutoff, beta):
+  """One side of the lowpass, cutoff relative to Nyquist."""
+  norm = bessel_i0(beta)
+  table = []
+  for i in range(ZERO_CROSSINGS * RESOLUTION + 1):
+    x = i / RESOLUTION
+    sinc = 1.0 if x == 0 else math.sin(math.pi * cutoff * x) / (math.pi * cutoff * x)
+    ratio = x / ZERO_CROSSINGS
+    window = bessel_i0(beta * math.sqrt(max(0.0, 1.0 - ratio * ratio))) / norm
+    table.append(int(round(cutoff * sinc * window * ONE)))
+  return table
+
+
+def response(table, f):
+  """Magnitude at f (relative to input Nyquist) of the continuous filter."""
+  total = table[0] / RESOLUTION
+  for i in range(1, len(table)):
+    total += 2.0 * table[i] / RESOLUTION * math.cos(math.pi * f * i / RESOLUTION)
+  return abs(total) / ONE
+
+
+def phase_table(table, l, m):
+  """Model of ResampleBuildPhases: Q30 polyphase coefficients, one row per phase."""
+  d = max(l, m)
+  taps = (2 * ((ZERO_CROSSINGS * d + l - 1) // l) + 3) & ~3
+  rows = []
+  for p in range(l):
+    row = []
+    for j in range(taps):
+      pos = abs(p + (taps // 2 - 1 - j) * l) * RESOLUTION
+      index, rem = divmod(pos, d)
+      if index >= len(table) - 1:
+        row.append(0)
+        continue
+      row.append(table[index] + (table[index + 1] - table[index]) * rem // d)
+    total = sum(row)
+    # Rounded half away from zero, as in C.
+    q = [((c << COEF_SHIFT) + total // 2) // total if c >= 0 else -(((-c << COEF_SHIFT) + total // 2) // total) for c in row]
+    peak = q.index(max(q))
+    q[peak] += (1 << COEF_SHIFT) - sum(q)
+    rows.append(q)
+  return taps, rows
+
+
+def resample(table, samples, l, m):
+  """Model of the resampler inner loop, 16-bit mono."""
+  taps, rows = phase_table(table, l, m)
+  window = [0] * (taps // 2 - 1) + samples + [0] * (taps // 2)
+  out = []
+  base = 0
+  phase = 0
+  center = 0
+  while center < len(samples):
+    acc = sum(window[base + j] * rows[phase][j] for j in range(taps))
+    out.append(max(-32768, min(32767, (acc + (1 << (COEF_SHIFT - 1))) >> COEF_SHIFT)))
+    phase += m
+    base += phase // l
+    center += phase // l
+    phase %= l
+  return out
+
+
+def check(table):
+  ripple = [20 * math.log10(response(table, f / 100.0)) for f in range(0, 86)]
+  stop = [20 * math.log10(max(1e-12, response(table, f / 100.0))) for f in range(100, 301, 2)]
+  print('Passband (0-0.85 Nyquist) ripple: %+.3f/%+.3f dB' % (min(ripple), max(ripple)))
+  print('Stopband (>= Nyquist) attenuation: %.1f dB' % -max(stop))
+
+  for rate_in, rate_out in ((44100, 48000), (48000, 44100), (48000, 96000), (96000, 48000), (44100, 96000)):
+    g = math.gcd(rate_in, rate_out)
+    l, m = rate_out // g, rate_in // g
+    tone = 1000.0
+    count = rate_in // 10
+    src = [int(round(16384 * math.sin(2 * math.pi * tone * n / rate_in))) for n in range(count)]
+    out = resample(table, src, l, m)
+    # Skip filter edges, compare against the ideal sine at the output rate.
+    taps = 2 * ZERO_CROSSINGS * max(l, m) // l
+    signal = noise = 0.0
+    for k in range(taps, len(out) - taps):
+      ref = 16384 * math.sin(2 * math.pi * tone * k / rate_out)
+      signal += ref * ref
+      noise += (out[k] - ref) ** 2
+    print('%6u -> %6u Hz: %5u frames out, SNR %.1f dB' % (rate_in, rate_out, len(out), 10 * math.log10(signal / max(noise, 1e-9))))
+
+
+def emit(output, table, cutoff, beta):
+  lines = []
+  for i in range(0, len(table), VALUES_PER_LINE):
+    lines.append('  ' + ', '.join('%d' % v for v in table[i:i + VALUES_PER_LINE]))
+
+  with open(output, 'w', newline='\n') as f:
+    f.write('/*\n')
+    f.write(' * File: %s\n' % os.path.basename(output))
+    f.write(' *\n')
+    f.write(' * Description: Resampler prototype lowpass, Kaiser windowed sinc,\n')
+    f.write(' * cutoff %.2f of Nyquist, beta %.1f.\n' % (cutoff, beta))
+    f.write(' *\n')
+    f.write(' * Generated by Tools/FilterGen.py, do not edit.\n')
+    f.write(' *\n')
+    f.write(' */\n\n')
+    f.write('#include "AudioDxeCfg.h"\n\n')
+    f.write('CONST INT32 mResampleFilter[RESAMPLE_FILTER_LENGTH] = {\n')
+    f.write(',\n'.join(lines))
+    f.write('\n};\n')
+
+
+def main():
+  parser = argparse.ArgumentParser(description='Generate the resampler prototype filter for AudioDxeCfg.')
+  parser.add_argument('-o', '--output', default='ResampleFilter.c', help='output C source')
+  parser.add_argument('--cutoff', type=float, default=0.91, help='cutoff relative to Nyquist')
+  parser.add_argument('--beta', type=float, default=9.0, help='Kaiser window beta')
+  parser.add_argument('--check', action='store_true', help='measure filter and resampler quality only')
+  args = parser.parse_args()
+
+  table = prototype(args.cutoff, args.beta)
+  if args.check:
+    check(table)
+    return 0
+
+  emit(args.output, table, args.cutoff, args.beta)
+  print('FilterGen: wrote %s, %u coefficients' % (args.output, len(table)))
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
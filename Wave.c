@@ -0,0 +1,210 @@
+/*
+ * File: Wave.c
+ *
+ * Description: RIFF/WAVE header parsing for in-place playback.
+ *
+ * Copyright (c) 2018-2019 John Davis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "AudioDxeCfg.h"
+
+#define WAVE_RIFF_ID              SIGNATURE_32 ('R', 'I', 'F', 'F')
+#define WAVE_WAVE_ID              SIGNATURE_32 ('W', 'A', 'V', 'E')
+#define WAVE_FMT_ID               SIGNATURE_32 ('f', 'm', 't', ' ')
+#define WAVE_DATA_ID              SIGNATURE_32 ('d', 'a', 't', 'a')
+
+#define WAVE_RIFF_HEADER_SIZE     (12)
+#define WAVE_CHUNK_HEADER_SIZE    (8)
+#define WAVE_FMT_SIZE             (16)
+#define WAVE_FMT_EXTENSIBLE_SIZE  (40)
+
+// Supported sample rates.
+STATIC CONST struct {
+  UINT32                      Hz;
+  EFI_AUDIO_IO_PROTOCOL_FREQ  Frequency;
+} mFrequencies[] = {
+  { 8000,   EfiAudioIoFreq8kHz   },
+  { 11025,  EfiAudioIoFreq11kHz  },
+  { 16000,  EfiAudioIoFreq16kHz  },
+  { 22050,  EfiAudioIoFreq22kHz  },
+  { 32000,  EfiAudioIoFreq32kHz  },
+  { 44100,  EfiAudioIoFreq44kHz  },
+  { 48000,  EfiAudioIoFreq48kHz  },
+  { 88200,  EfiAudioIoFreq88kHz  },
+  { 96000,  EfiAudioIoFreq96kHz  },
+  { 192000, EfiAudioIoFreq192kHz }
+};
+
+EFI_AUDIO_IO_PROTOCOL_FREQ
+AudioIoFreqFromHz (
+  IN  UINT32    Hz
+  )
+{
+  UINTN   i;
+
+  //
+
+  for (i = 0; i < ARRAY_SIZE (mFrequencies); i++) {
+    if (mFrequencies[i].Hz == Hz) {
+      return mFrequencies[i].Frequency;
+    }
+  }
+
+  return 0;
+}
+
+UINT32
+AudioIoFreqToHz (
+  IN  EFI_AUDIO_IO_PROTOCOL_FREQ  Frequency
+  )
+{
+  UINTN   i;
+
+  //
+
+  for (i = 0; i < ARRAY_SIZE (mFrequencies); i++) {
+    if (mFrequencies[i].Frequency == Frequency) {
+      return mFrequencies[i].Hz;
+    }
+  }
+
+  return 0;
+}
+
+EFI_STATUS
+WaveParse (
+  IN  CONST UINT8   *Data,
+  IN  UINTN         DataLength,
+  OUT WAVE_INFO     *WaveInfo
+  )
+{
+  UINTN     Offset;
+  UINT32    ChunkId;
+  UINT32    ChunkSize;
+  BOOLEAN   HasFormat;
+
+  //
+
+  if ((Data == NULL) || (WaveInfo == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if ((DataLength < WAVE_RIFF_HEADER_SIZE)
+    || (ReadUnaligned32 ((CONST UINT32 *)&Data[0]) != WAVE_RIFF_ID)
+    || (ReadUnaligned32 ((CONST UINT32 *)&Data[8]) != WAVE_WAVE_ID)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  ZeroMem (WaveInfo, sizeof (*WaveInfo));
+  HasFormat = FALSE;
+
+  // Walk chunks until the data chunk, which must follow the format chunk.
+  for (Offset = WAVE_RIFF_HEADER_SIZE; (Offset + WAVE_CHUNK_HEADER_SIZE) <= DataLength; Offset += ChunkSize + (ChunkSize & 1)) {
+    ChunkId     = ReadUnaligned32 ((CONST UINT32 *)&Data[Offset]);
+    ChunkSize   = ReadUnaligned32 ((CONST UINT32 *)&Data[Offset + 4]);
+    Offset     += WAVE_CHUNK_HEADER_SIZE;
+
+    if (ChunkId == WAVE_FMT_ID) {
+      if ((ChunkSize < WAVE_FMT_SIZE) || ((Offset + WAVE_FMT_SIZE) > DataLength)) {
+        return EFI_VOLUME_CORRUPTED;
+      }
+
+      WaveInfo->FormatTag     = ReadUnaligned16 ((CONST UINT16 *)&Data[Offset]);
+      WaveInfo->Channels      = ReadUnaligned16 ((CONST UINT16 *)&Data[Offset + 2]);
+      WaveInfo->SamplesPerSec = ReadUnaligned32 ((CONST UINT32 *)&Data[Offset + 4]);
+      WaveInfo->BlockAlign    = ReadUnaligned16 ((CONST UINT16 *)&Data[Offset + 12]);
+      WaveInfo->BitsPerSample = ReadUnaligned16 ((CONST UINT16 *)&Data[Offset + 14]);
+
+      // Extensible format carries the actual format tag in its sub-format GUID.
+      if ((WaveInfo->FormatTag == WAVE_FORMAT_EXTENSIBLE)
+        && (ChunkSize >= WAVE_FMT_EXTENSIBLE_SIZE)
+        && ((Offset + WAVE_FMT_EXTENSIBLE_SIZE) <= DataLength)) {
+        WaveInfo->FormatTag = ReadUnaligned16 ((CONST UINT16 *)&Data[Offset + 24]);
+      }
+
+      HasFormat = TRUE;
+    } else if (ChunkId == WAVE_DATA_ID) {
+      if (!HasFormat) {
+        return EFI_VOLUME_CORRUPTED;
+      }
+
+      // Tolerate truncated data chunks.
+      WaveInfo->DataOffset = (UINT32)Offset;
+      WaveInfo->DataLength = (UINT32)MIN (ChunkSize, DataLength - Offset);
+
+      return EFI_SUCCESS;
+    }
+  }
+
+  return EFI_VOLUME_CORRUPTED;
+}
+
+EFI_STATUS
+WaveGetAudioIoFormat (
+  IN  CONST WAVE_INFO               *WaveInfo,
+  OUT EFI_AUDIO_IO_PROTOCOL_FREQ    *Frequency,
+  OUT EFI_AUDIO_IO_PROTOCOL_BITS    *Bits
+  )
+{
+  //
+
+  if ((WaveInfo == NULL) || (Frequency == NULL) || (Bits == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if ((WaveInfo->FormatTag != WAVE_FORMAT_PCM) || (WaveInfo->Channels == 0) || (WaveInfo->Channels > MAX_UINT8)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  *Frequency = AudioIoFreqFromHz (WaveInfo->SamplesPerSec);
+  if (*Frequency == 0) {
+    return EFI_UNSUPPORTED;
+  }
+
+  //
+  // Only layouts matching HD audio streams can be played in place. 8-bit WAV
+  // samples are unsigned and packed 24-bit ones have no 32-bit container.
+  //
+  if (WaveInfo->BlockAlign == (WaveInfo->Channels * 2)) {
+    *Bits = (WaveInfo->BitsPerSample == 16) ? EfiAudioIoBits16 : 0;
+  } else if (WaveInfo->BlockAlign == (WaveInfo->Channels * 4)) {
+    switch (WaveInfo->BitsPerSample) {
+      case 20:
+        *Bits = EfiAudioIoBits20;
+        break;
+
+      case 24:
+        *Bits = EfiAudioIoBits24;
+        break;
+
+      case 32:
+        *Bits = EfiAudioIoBits32;
+        break;
+
+      default:
+        *Bits = 0;
+    }
+  } else {
+    *Bits = 0;
+  }
+
+  return (*Bits != 0) ? EFI_SUCCESS : EFI_UNSUPPORTED;
+}